@@ -0,0 +1,575 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "types.h"
+#include "game.h"
+#include "deck.h"
+#include "util.h"
+#include "abstraction.h"
+#include "strategy.h"
+#include "cfr.h"
+#include "merge.h"
+
+// Fixed-seed microbenchmarks of the core kernels
+// - Every benchmark runs one untimed warm-up and then reps timed repetitions
+//   of the same work; the CSV has the median (ns_per_op) and the best repetition
+//   (min_ns_per_op), which bench/compare.sh checks as the least noisy figure
+// - Inputs come from BENCH_SEED only, so runs on one machine and build are comparable
+// - Results go to a CSV file for bench/compare.sh; a readable table goes to stdout
+
+#define BENCH_SEED 20260101u
+#define DEFAULT_REPS 7
+#define MAX_REPS 100
+
+#define DEAL_OPS 20000          // make_cards_and_deal calls per repetition
+#define POOL_DEALS 5000         // Random playouts the state pool is drawn from
+#define KERNEL_OPS 200000       // legal_play / apply_play / build_key / score calls per repetition
+#define TABLE_KEYS 50000        // Pool keys for get_or_create (repeats hit the node just made)
+#define RECURSE_DEALS 50        // Fixed deal set for recurse (both players per deal)
+#define FIND_OPS 200000         // find_node lookups per repetition
+#define KWAYP_FILES 4           // Unsorted Strat files the kwayp benchmarks merge
+#define FANIN_MAX 500           // Most sorted files kwayp_merge_k* merges
+
+// Decision and terminal states from random playouts
+typedef struct {
+    State *play;        // PLAY-stage decisions
+    long play_n;
+    State *any;         // Every decision (BID and PLAY)
+    long any_n;
+    State *done;        // Finished hands
+    long done_n;
+} Pool;
+
+typedef struct {
+    const char *name;
+    long ops;           // Operations per repetition
+    long items;         // Items per repetition (deals, visits or records where that differs from ops)
+    int reps;
+    double ns[MAX_REPS];
+} Result;
+
+static volatile long sink;  // Keeps results of benchmarked calls alive
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double median_ns(Result *r)
+{
+    double sorted[MAX_REPS];
+    memcpy(sorted, r->ns, r->reps * sizeof(double));
+    qsort(sorted, r->reps, sizeof(double), compare_double);
+    return sorted[r->reps / 2];
+}
+
+static double min_ns(Result *r)
+{
+    double m = r->ns[0];
+    for (int i = 1; i < r->reps; i++)
+        if (r->ns[i] < m) m = r->ns[i];
+    return m;
+}
+
+static void report(FILE *csv, Result *r)
+{
+    double med = median_ns(r);
+    double ns_op = med / r->ops;
+    double items_sec = r->items / (med / 1e9);
+    printf("%-24s %12.1f ns/op %14.0f items/s  (%ld ops x %d reps, min %.1f ns/op)\n",
+           r->name, ns_op, items_sec, r->ops, r->reps, min_ns(r) / r->ops);
+    fprintf(csv, "%s,%ld,%ld,%d,%.3f,%.3f,%.1f\n",
+            r->name, r->ops, r->items, r->reps, ns_op, min_ns(r) / r->ops, items_sec);
+    fflush(stdout);
+}
+
+static void apply_action(State *sp, UC action)
+{
+    if (sp->stage == BID) {
+        apply_bid(sp, action);
+    } else {
+        UC card_index = bind_card_index_to_action(sp, action);
+        apply_play(sp, card_index);
+    }
+}
+
+// Same deal setup as ct's train_deal
+static void bench_deal(State *s, unsigned int seed, long deal)
+{
+    Rng rng;
+    rng_init(&rng, seed, (uint64_t)deal);
+    memset(s, 0, sizeof(State));
+    s->seed = (unsigned int)rng_next(&rng);
+    s->dealer = rng_bounded(&rng, 2);
+    s->stage = BID;
+    s->to_act = 1 - s->dealer;
+    s->trump = PRE_TRUMP;
+    deal_hands(s, &rng);
+}
+
+// Play POOL_DEALS hands with uniformly random legal actions, keeping every state seen
+static int build_pool(Pool *pool)
+{
+    long cap = POOL_DEALS * (2 * HAND_SIZE + 4);
+    pool->play = malloc(cap * sizeof(State));
+    pool->any = malloc(cap * sizeof(State));
+    pool->done = malloc(POOL_DEALS * sizeof(State));
+    if (!pool->play || !pool->any || !pool->done) {
+        fprintf(stderr, "Error: Cannot allocate the state pool\n");
+        return -1;
+    }
+    pool->play_n = pool->any_n = pool->done_n = 0;
+
+    Rng rng;
+    rng_init(&rng, BENCH_SEED, 0xb0b0);
+    for (long d = 0; d < POOL_DEALS; d++) {
+        State s;
+        bench_deal(&s, BENCH_SEED + 1, d);
+        while (!s.hand_done && pool->any_n < cap) {
+            UC actions[MAX_ACTIONS];
+            int n = (s.stage == BID) ? legal_bid(&s, actions) : legal_play(&s, actions);
+            pool->any[pool->any_n++] = s;
+            if (s.stage == PLAY) pool->play[pool->play_n++] = s;
+            apply_action(&s, actions[rng_bounded(&rng, n)]);
+        }
+        if (s.hand_done) pool->done[pool->done_n++] = s;
+    }
+    return 0;
+}
+
+static void free_pool(Pool *pool)
+{
+    free(pool->play);
+    free(pool->any);
+    free(pool->done);
+}
+
+// Timed loop shared by the per-call kernels: warm-up, then reps
+#define BENCH_LOOP(r, body)                                   \
+    do {                                                      \
+        for (int rep_ = -1; rep_ < (r)->reps; rep_++) {       \
+            double t0_ = now_ns();                            \
+            body;                                             \
+            double t1_ = now_ns();                            \
+            if (rep_ >= 0) (r)->ns[rep_] = t1_ - t0_;         \
+        }                                                     \
+    } while (0)
+
+static void bench_make_cards_and_deal(FILE *csv, int reps)
+{
+    Result r = { "make_cards_and_deal", DEAL_OPS, DEAL_OPS, reps, {0} };
+    State s = {0};
+    BENCH_LOOP(&r, {
+        s.seed = BENCH_SEED;
+        for (long i = 0; i < DEAL_OPS; i++) {
+            make_cards_and_deal(&s);
+            sink += s.hp[0].card[0].rank;
+        }
+    });
+    report(csv, &r);
+}
+
+static void bench_legal_play(FILE *csv, int reps, Pool *pool)
+{
+    Result r = { "legal_play", KERNEL_OPS, KERNEL_OPS, reps, {0} };
+    UC actions[MAX_ACTIONS];
+    BENCH_LOOP(&r, {
+        for (long i = 0; i < KERNEL_OPS; i++)
+            sink += legal_play(&pool->play[i % pool->play_n], actions);
+    });
+    report(csv, &r);
+}
+
+// Includes the State copy apply_play needs to leave the pool untouched
+static void bench_apply_play(FILE *csv, int reps, Pool *pool)
+{
+    UC *index = malloc(pool->play_n);
+    if (!index) return;
+    for (long i = 0; i < pool->play_n; i++) {
+        UC actions[MAX_ACTIONS];
+        legal_play(&pool->play[i], actions);
+        index[i] = bind_card_index_to_action(&pool->play[i], actions[0]);
+    }
+
+    Result r = { "apply_play", KERNEL_OPS, KERNEL_OPS, reps, {0} };
+    BENCH_LOOP(&r, {
+        for (long i = 0; i < KERNEL_OPS; i++) {
+            long j = i % pool->play_n;
+            State s = pool->play[j];
+            apply_play(&s, index[j]);
+            sink += s.to_act;
+        }
+    });
+    report(csv, &r);
+    free(index);
+}
+
+static void bench_build_key(FILE *csv, int reps, Pool *pool)
+{
+    Result r = { "build_key", KERNEL_OPS, KERNEL_OPS, reps, {0} };
+    BENCH_LOOP(&r, {
+        for (long i = 0; i < KERNEL_OPS; i++) {
+            Key k = build_key(&pool->any[i % pool->any_n]);
+            sink += k.bits[0];
+        }
+    });
+    report(csv, &r);
+}
+
+// score rewrites the score fields from the tricks, so calling it again on the same state is fine
+static void bench_score(FILE *csv, int reps, Pool *pool)
+{
+    Result r = { "score", KERNEL_OPS, KERNEL_OPS, reps, {0} };
+    BENCH_LOOP(&r, {
+        for (long i = 0; i < KERNEL_OPS; i++)
+            sink += score(&pool->done[i % pool->done_n]);
+    });
+    report(csv, &r);
+}
+
+// Inserts into an empty slice, then lookups of the same keys (all hits)
+static void bench_get_or_create(FILE *csv, int reps, Pool *pool, Node **table)
+{
+    long n = pool->any_n < TABLE_KEYS ? pool->any_n : TABLE_KEYS;
+    Key *keys = malloc(n * sizeof(Key));
+    UC (*actions)[MAX_ACTIONS] = malloc(n * sizeof(*actions));
+    UC *legal_n = malloc(n);
+    uint16_t *mask = malloc(n * sizeof(uint16_t));
+    if (!keys || !actions || !legal_n || !mask) {
+        fprintf(stderr, "Error: Cannot allocate get_or_create inputs\n");
+        exit(1);
+    }
+    for (long i = 0; i < n; i++) {
+        State *s = &pool->any[i];
+        keys[i] = build_key(s);
+        legal_n[i] = (s->stage == BID) ? legal_bid(s, actions[i]) : legal_play(s, actions[i]);
+        mask[i] = action_mask(actions[i], legal_n[i]);
+    }
+
+    // Insert cost: slice 0 is emptied before every repetition (untimed)
+    Result ins = { "get_or_create_insert", n, n, reps, {0} };
+    for (int rep = -1; rep < reps; rep++) {
+        for (long i = 0; i < NODE_QTY; i++) {
+            Node *cur = table[i];
+            while (cur) {
+                Node *next = cur->next;
+                free(cur);
+                cur = next;
+            }
+            table[i] = NULL;
+        }
+        cfr_release_nodes(0, cfr_slice_nodes(0), cfr_slice_buckets(0));
+        double t0 = now_ns();
+        for (long i = 0; i < n; i++)
+            sink += get_or_create(table, &keys[i], actions[i], legal_n[i], mask[i], 0)->action_count;
+        double t1 = now_ns();
+        if (rep >= 0) ins.ns[rep] = t1 - t0;
+    }
+    report(csv, &ins);
+
+    Result hit = { "get_or_create_hit", n, n, reps, {0} };
+    BENCH_LOOP(&hit, {
+        for (long i = 0; i < n; i++)
+            sink += get_or_create(table, &keys[i], actions[i], legal_n[i], mask[i], 0)->action_count;
+    });
+    report(csv, &hit);
+
+    // The same hits with the striped locks of --split-depth, uncontended
+    Result shared = { "get_or_create_hit_shared", n, n, reps, {0} };
+    cfr_set_shared(true);
+    BENCH_LOOP(&shared, {
+        for (long i = 0; i < n; i++)
+            sink += get_or_create(table, &keys[i], actions[i], legal_n[i], mask[i], 0)->action_count;
+    });
+    cfr_set_shared(false);
+    report(csv, &shared);
+
+    free(keys);
+    free(actions);
+    free(legal_n);
+    free(mask);
+}
+
+// CFR traversal of a fixed deal set on slice 1; items are node visits
+// - shared: with the striped locks of --split-depth, on one thread
+static void bench_recurse(FILE *csv, int reps, Node **table, const char *name, bool shared)
+{
+    atomic_long visits = 0;
+    cfr_set_visit_counter(&visits);
+    cfr_set_shared(shared);
+
+    Result r = { name, RECURSE_DEALS, 0, reps, {0} };
+    for (int rep = -1; rep < reps; rep++) {
+        long before = atomic_load(&visits);
+        double t0 = now_ns();
+        for (long d = 0; d < RECURSE_DEALS; d++) {
+            State s;
+            bench_deal(&s, BENCH_SEED, d);
+            recurse(&s, table, 0, 1);
+            recurse(&s, table, 1, 1);
+        }
+        double t1 = now_ns();
+        if (rep >= 0) {
+            r.ns[rep] = t1 - t0;
+            r.items = atomic_load(&visits) - before;
+        }
+    }
+    cfr_set_visit_counter(NULL);
+    cfr_set_shared(false);
+    report(csv, &r);
+}
+
+// Write slice 1 round robin as nfiles unsorted Strat files (hash order, as ct writes them)
+static long write_strat_files(Node **table, char files[][64], int nfiles)
+{
+    FILE *fp[FANIN_MAX];
+    for (int f = 0; f < nfiles; f++) {
+        fp[f] = fopen(files[f], "wb");
+        if (!fp[f]) {
+            fprintf(stderr, "Error: Cannot open %s for writing\n", files[f]);
+            for (int g = 0; g < f; g++) fclose(fp[g]);
+            return -1;
+        }
+    }
+    long count = 0;
+    for (long i = 0; i < NODE_QTY; i++) {
+        for (Node *cur = table[NODE_QTY + i]; cur; cur = cur->next) {
+            Strat st = {0};
+            memcpy(st.bits, cur->key.bits, KEY_BYTES);
+            st.action_count = cur->action_count;
+            memcpy(st.action, cur->action, MAX_ACTIONS);
+            st.mask = cur->mask;
+            node_average(cur, st.strategy);
+            fwrite(&st, sizeof(Strat), 1, fp[count % nfiles]);
+            count++;
+        }
+    }
+    for (int f = 0; f < nfiles; f++) fclose(fp[f]);
+    return count;
+}
+
+// merge_strategies and load_strategy report progress on stdout; keep it out of the table
+static int mute_stdout(void)
+{
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    if (saved >= 0 && devnull >= 0) dup2(devnull, STDOUT_FILENO);
+    if (devnull >= 0) close(devnull);
+    return saved;
+}
+
+static void unmute_stdout(int saved)
+{
+    fflush(stdout);
+    if (saved >= 0) {
+        dup2(saved, STDOUT_FILENO);
+        close(saved);
+    }
+}
+
+static int quiet_merge(MergeConfig *config, MergeStats *stats, bool sort)
+{
+    int saved = mute_stdout();
+    int rc = sort ? merge_strategies(config, stats) : merge_sorted_files(config, stats);
+    unmute_stdout(saved);
+    return rc;
+}
+
+// kwayp on the recurse table: sort + merge of unsorted files, then merge of sorted ones
+// - Leaves the merged Strat_255 file at out for find_node
+static int bench_kwayp(FILE *csv, int reps, Node **table, const char *dir, char *out)
+{
+    char files[KWAYP_FILES][64];
+    char *names[KWAYP_FILES];
+    for (int f = 0; f < KWAYP_FILES; f++) {
+        snprintf(files[f], sizeof(files[f]), "%s/in%d.bin", dir, f);
+        names[f] = files[f];
+    }
+    MergeConfig config = { KWAYP_FILES, names, out, 0, 1, 0, false };
+    MergeStats stats;
+
+    long count = 0;
+    Result sm = { "kwayp_sort_merge", 1, 0, reps, {0} };
+    for (int rep = -1; rep < reps; rep++) {
+        count = write_strat_files(table, files, KWAYP_FILES);
+        if (count < 0) return -1;
+        double t0 = now_ns();
+        if (quiet_merge(&config, &stats, true) != 0) return -1;
+        double t1 = now_ns();
+        if (rep >= 0) sm.ns[rep] = t1 - t0;
+    }
+    sm.items = count;
+    report(csv, &sm);
+
+    // The inputs are sorted now, so only the order check and the merge remain
+    Result m = { "kwayp_merge", 1, count, reps, {0} };
+    BENCH_LOOP(&m, {
+        if (quiet_merge(&config, &stats, true) != 0) return -1;
+    });
+    report(csv, &m);
+
+    for (int f = 0; f < KWAYP_FILES; f++) unlink(files[f]);
+    return 0;
+}
+
+// Merge phase alone over the same records split into k sorted files
+static int bench_kwayp_fanin(FILE *csv, int reps, Node **table, const char *dir)
+{
+    static const int fanin[] = { 2, 20, 100, 500 };
+    static const char *names[] = { "kwayp_merge_k2", "kwayp_merge_k20", "kwayp_merge_k100", "kwayp_merge_k500" };
+    char (*files)[64] = malloc(FANIN_MAX * sizeof(*files));
+    char **paths = malloc(FANIN_MAX * sizeof(char *));
+    char out[64];
+    snprintf(out, sizeof(out), "%s/fanin.bin", dir);
+    int rc = (files && paths) ? 0 : -1;
+
+    for (int t = 0; t < 4 && rc == 0; t++) {
+        int k = fanin[t];
+        for (int f = 0; f < k; f++) {
+            snprintf(files[f], sizeof(files[f]), "%s/k%d.bin", dir, f);
+            paths[f] = files[f];
+        }
+        MergeConfig config = { k, paths, out, 0, 1, 0, false };
+        MergeStats stats;
+        long count = write_strat_files(table, files, k);
+        if (count < 0 || quiet_merge(&config, &stats, true) != 0) {
+            rc = -1;
+            break;
+        }
+
+        Result r = { names[t], 1, count, reps, {0} };
+        BENCH_LOOP(&r, {
+            if (quiet_merge(&config, &stats, false) != 0) return -1;
+        });
+        report(csv, &r);
+        for (int f = 0; f < k; f++) unlink(files[f]);
+    }
+
+    unlink(out);
+    free(paths);
+    free(files);
+    return rc;
+}
+
+// Binary search for keys sampled from the strategy file (all hits)
+static int bench_find_node(FILE *csv, int reps, const char *filename)
+{
+    long count = 0;
+    int saved = mute_stdout();
+    Strat_255 *strat = load_strategy(filename, &count);
+    unmute_stdout(saved);
+    if (!strat || count == 0) return -1;
+
+    Key *keys = malloc(FIND_OPS * sizeof(Key));
+    if (!keys) {
+        free_strategy(strat, count);
+        return -1;
+    }
+    Rng rng;
+    rng_init(&rng, BENCH_SEED, 0xf1d);
+    for (long i = 0; i < FIND_OPS; i++) {
+        memset(&keys[i], 0, sizeof(Key));
+        memcpy(keys[i].bits, strat[rng_next(&rng) % count].bits, KEY_BYTES);
+    }
+
+    Result r = { "find_node", FIND_OPS, FIND_OPS, reps, {0} };
+    BENCH_LOOP(&r, {
+        for (long i = 0; i < FIND_OPS; i++)
+            sink += find_node(strat, count, &keys[i]);
+    });
+    report(csv, &r);
+
+    free(keys);
+    free_strategy(strat, count);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || argc > 4) {
+        fprintf(stderr, "Usage: %s <csv_file> [reps [strategy_file]]\n", argv[0]);
+        fprintf(stderr, "  reps: timed repetitions per benchmark (default %d)\n", DEFAULT_REPS);
+        fprintf(stderr, "  strategy_file: merged Strat_255 file for find_node (default: the kwayp benchmark's output)\n");
+        return 1;
+    }
+    const char *csv_file = argv[1];
+    int reps = (argc >= 3) ? atoi(argv[2]) : DEFAULT_REPS;
+    const char *strategy_file = (argc >= 4) ? argv[3] : NULL;
+    if (reps <= 0 || reps > MAX_REPS) {
+        fprintf(stderr, "Error: reps must be between 1 and %d\n", MAX_REPS);
+        return 1;
+    }
+
+    FILE *csv = fopen(csv_file, "w");
+    if (!csv) {
+        fprintf(stderr, "Error: Cannot open %s for writing\n", csv_file);
+        return 1;
+    }
+    fprintf(csv, "benchmark,ops,items,reps,ns_per_op,min_ns_per_op,items_per_sec\n");
+
+    char dir[] = "/tmp/ct-bench-XXXXXX";
+    if (!mkdtemp(dir)) {
+        fprintf(stderr, "Error: Cannot create a scratch directory\n");
+        fclose(csv);
+        return 1;
+    }
+    char merged[64];
+    snprintf(merged, sizeof(merged), "%s/merged.bin", dir);
+
+    printf("=== CT-BENCH Microbenchmarks ===\n");
+    printf("Seed: %u, repetitions: %d (median reported)\n\n", BENCH_SEED, reps);
+
+    Pool pool;
+    Node **table = calloc(2L * NODE_QTY, sizeof(Node *));
+    if (build_pool(&pool) != 0 || !table) {
+        fprintf(stderr, "Error: Cannot allocate benchmark inputs\n");
+        fclose(csv);
+        return 1;
+    }
+    cfr_init_counts(2);
+
+    int rc = 0;
+    bench_make_cards_and_deal(csv, reps);
+    bench_legal_play(csv, reps, &pool);
+    bench_apply_play(csv, reps, &pool);
+    bench_build_key(csv, reps, &pool);
+    bench_score(csv, reps, &pool);
+    bench_get_or_create(csv, reps, &pool, table);
+    bench_recurse(csv, reps, table, "recurse", false);
+    bench_recurse(csv, reps, table, "recurse_shared", true);
+    if (bench_kwayp(csv, reps, table, dir, merged) != 0) {
+        fprintf(stderr, "Error: kwayp benchmark failed\n");
+        rc = 1;
+    }
+    if (rc == 0 && bench_kwayp_fanin(csv, reps, table, dir) != 0) {
+        fprintf(stderr, "Error: kwayp fan-in benchmark failed\n");
+        rc = 1;
+    }
+    if (rc == 0 || strategy_file) {
+        if (bench_find_node(csv, reps, strategy_file ? strategy_file : merged) != 0) {
+            fprintf(stderr, "Error: Cannot load strategy file for find_node\n");
+            rc = 1;
+        }
+    }
+
+    unlink(merged);
+    rmdir(dir);
+    free_pool(&pool);
+    fclose(csv);
+    printf("\nResults written to %s\n", csv_file);
+    return rc;
+}
@@ -0,0 +1,59 @@
+#!/bin/bash
+
+# compare.sh - Compare a ct-bench CSV against a stored baseline
+# Usage: bench/compare.sh <baseline_csv> <current_csv> [threshold_percent]
+# Compares the best repetition (min_ns_per_op), the least noisy figure; exits 1 if
+# any benchmark is more than threshold_percent (default 15) above the baseline
+
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 <baseline_csv> <current_csv> [threshold_percent]"
+    exit 1
+fi
+
+baseline="$1"
+current="$2"
+threshold="${3:-15}"
+
+for f in "$baseline" "$current"; do
+    if [ ! -f "$f" ]; then
+        echo "Error: $f not found"
+        exit 1
+    fi
+done
+
+echo "=== Benchmark Comparison (threshold ${threshold}%) ==="
+echo "Baseline: $baseline"
+echo "Current:  $current"
+echo ""
+
+# Columns: benchmark,ops,items,reps,ns_per_op,min_ns_per_op,items_per_sec
+awk -F',' -v t="$threshold" '
+    FNR == 1 { next }
+    NR == FNR { base[$1] = $6; order[++n] = $1; next }
+    {
+        cur[$1] = $6
+        if (!($1 in base)) order[++n] = $1
+    }
+    END {
+        printf "%-24s %14s %14s %9s  %s\n", "benchmark", "base best ns", "best ns", "change", "status"
+        regressions = 0
+        for (i = 1; i <= n; i++) {
+            name = order[i]
+            if (!(name in cur)) {
+                printf "%-24s %14.1f %14s %9s  %s\n", name, base[name], "-", "-", "MISSING"
+                continue
+            }
+            if (!(name in base)) {
+                printf "%-24s %14s %14.1f %9s  %s\n", name, "-", cur[name], "-", "NEW"
+                continue
+            }
+            change = (base[name] > 0) ? 100.0 * (cur[name] - base[name]) / base[name] : 0
+            status = "ok"
+            if (change > t) { status = "REGRESSION"; regressions++ }
+            else if (change < -t) status = "faster"
+            printf "%-24s %14.1f %14.1f %+8.1f%%  %s\n", name, base[name], cur[name], change, status
+        }
+        printf "\n%d regression(s)\n", regressions
+        exit (regressions > 0)
+    }
+' "$baseline" "$current"
@@ -24,6 +24,9 @@ if [ $# -lt 6 ] || [ $# -gt 7 ]; then
     echo "  seed            - Base random seed (0 for random)"
     echo "  dataset_mode    - Optional: 3=bid NN dataset, 4=play NN dataset (omit to skip)"
     echo ""
+    echo "Environment:"
+    echo "  CT_OPTS         - Extra ct options, e.g. \"--time-limit 600 --converge 0.05\""
+    echo ""
     echo "Examples:"
     echo "  $0 20 250000 1 3 10000 0        # no dataset"
     echo "  $0 20 250000 1 3 10000 0 3      # bid NN dataset"
@@ -38,6 +41,7 @@ THRESHOLD=$4
 EVAL_GAMES=$5
 BASE_SEED=$6
 DATASET_MODE=${7:-}   # empty = no dataset generation
+CT_OPTS=${CT_OPTS:-}  # extra ct options (time budget, convergence stop, ...)
 
 # Generate base seed if 0
 if [ $BASE_SEED -eq 0 ]; then
@@ -99,10 +103,10 @@ train_models() {
             local output_file="${TEMP_DIR}/run_${i}.bin"
             
             log "Starting run $((i + 1))/$RUNS with seed $run_seed"
-            log "Executing ./bin/ct $THREADS $ITERATIONS $THRESHOLD $output_file $run_seed"
+            log "Executing ./bin/ct $CT_OPTS $THREADS $ITERATIONS $THRESHOLD $output_file $run_seed"
             
-            # Run training
-            ./bin/ct $THREADS $ITERATIONS $THRESHOLD $output_file $run_seed >> "$LOG_FILE" 2>&1
+            # Run training (CT_OPTS deliberately unquoted so it splits into options)
+            ./bin/ct $CT_OPTS $THREADS $ITERATIONS $THRESHOLD $output_file $run_seed >> "$LOG_FILE" 2>&1
             
             if [ $? -ne 0 ]; then
                 log_error "Training run $i failed"
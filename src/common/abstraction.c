@@ -2,6 +2,7 @@
 // Licensed under the GPL v3.0 License. See README.md for details.
 #include "game.h"
 #include "abstraction.h"
+#include "prof.h"
 
 // History counters for both players, packed one byte per context:
 //   Trump byte: [TH:2 | TJ:1 | TL:2 | TG:3]
@@ -64,6 +65,7 @@ void abs_cards_in_hand(State *s, Key *k)
 // - Split by trump/non-trump and Face/Rank
 Key build_key(State *sp)
 {
+    PROF_SCOPE(PROF_BUILD_KEY);
     Key k = {0};
     memset(&k, 0x00, sizeof(Key));
 
@@ -2,6 +2,7 @@
 // Licensed under the GPL v3.0 License. See README.md for details.
 #include "deck.h"
 #include "util.h"
+#include "prof.h"
 
 // Initialize deck with values 0-51
 void init_deck(char deck[DECK_SIZE])
@@ -76,6 +77,23 @@ void make_cards_and_deal(State *sp)
     make_formatted_hands(sp, raw_hand);
 }
 
+// Deal both hands from a counter-based stream
+// - Partial Fisher-Yates: only the PLAYERS * HAND_SIZE dealt positions are drawn,
+//   not a full 51-step shuffle of the deck
+void deal_hands(State *sp, Rng *rng)
+{
+    char deck[DECK_SIZE];
+    char raw_hand[PLAYERS][DECK_SIZE];
+
+    init_deck(deck);
+    for (int i = 0; i < PLAYERS * HAND_SIZE; i++) {
+        int j = i + rng_bounded(rng, DECK_SIZE - i);
+        swap(&deck[i], &deck[j]);
+    }
+    deal(deck, raw_hand);
+    make_formatted_hands(sp, raw_hand);
+}
+
 // Initialize score structure
 void init_score(Score *s)
 {
@@ -99,6 +117,7 @@ char add_game(Card card)
 // Score the hand and return utility (P0 score - P1 score)
 int score(State *s)
 {
+    PROF_SCOPE(PROF_SCORE);
     init_score(&s->score[0]);
     init_score(&s->score[1]);
     memset(&s->cards_won, 0x00, sizeof(s->cards_won));
@@ -13,8 +13,9 @@ void deal(char deck[DECK_SIZE], char raw_hand[PLAYERS][DECK_SIZE]);
 // Hand formatting
 void make_formatted_hands(State *sp, char raw_hand[PLAYERS][DECK_SIZE]);
 
-// High-level deal function
+// High-level deal functions
 void make_cards_and_deal(State *sp);
+void deal_hands(State *sp, Rng *rng);
 
 // Scoring
 void init_score(Score *s);
@@ -2,12 +2,14 @@
 // Licensed under the GPL v3.0 License. See README.md for details.
 #include "game.h"
 #include "util.h"
+#include "prof.h"
 
 // Legal bids 
 // - Return number of legal bid actions and populate output array with bid amounts
 // - Bids are 0 (pass), 1, 2, 3, interpreted as 0 (pass), 2, 3, 4 in game logic
 int legal_bid(State *s, UC out[4])
 {
+    PROF_SCOPE(PROF_LEGAL_BID);
     UC _1st_bidder = 1 - s->dealer;
     UC _2nd_bidder = s->dealer;
 
@@ -40,7 +42,7 @@ int legal_bid(State *s, UC out[4])
                 return 3;
             case 3: // First bidder bid 3(4)
                 out[0] = 0; // Can pass, 
-                out[0] = 3; // Can steal 
+                out[1] = 3; // Can steal 
                 return 2;
             default:
                 assert(false && "Invalid bid value");
@@ -231,11 +233,46 @@ bool is_legal_play(State *s, Card c)
         }
     }
 }
+// Bit for one action code (see game.h)
+uint16_t action_bit(UC action)
+{
+    if (action < 4) return 1u << action;                // Bid 0-3
+    if (action & 0x80) return 1u << (3 + (action & 0x0F)); // TH, TJ, TL, TG
+    return 1u << (7 + (action & 0x0F));                 // OP, ON
+}
+
+uint16_t action_mask(const UC *actions, int n)
+{
+    uint16_t mask = 0;
+    for (int i = 0; i < n; i++)
+        mask |= action_bit(actions[i]);
+    return mask;
+}
+
+// Permutation that puts an action array in bit order: actions[order[0]] comes first
+// - For records written before actions were listed in bit order
+void action_order(const UC *actions, int n, UC order[MAX_ACTIONS])
+{
+    for (int i = 0; i < n; i++) {
+        int j = i;
+        while (j > 0 && action_bit(actions[order[j - 1]]) > action_bit(actions[i])) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+}
+
+// Play action codes in bit order
+static const UC play_actions[] = { TH, TJ, TL, TG, OP, ON };
+
 // Return legal plays as abstracted actions
 // - Each unique action class appears at most once; card binding happens at play time
+// - Listed in bit order (TH, TJ, TL, TG, OP, ON) whatever the order of the hand
 int legal_play(State *s, unsigned char *o)
 {
-    bool seen[256] = {false};
+    PROF_SCOPE(PROF_LEGAL_PLAY);
+    uint16_t seen = 0;
     UC card_qty = HAND_SIZE - s->trick_num;
     UC p = s->to_act;
     UC oi = 0;
@@ -247,11 +284,12 @@ int legal_play(State *s, unsigned char *o)
         UC action = (s->trump != PRE_TRUMP && c.suit == s->trump)
                     ? get_trump_cat(c)
                     : get_other_cat(c);
+        seen |= action_bit(action);
+    }
 
-        if (!seen[action]) {
-            seen[action] = true;
-            o[oi++] = action;
-        }
+    for (int i = 0; i < (int)sizeof(play_actions); i++) {
+        if (seen & action_bit(play_actions[i]))
+            o[oi++] = play_actions[i];
     }
 
     assert(oi > 0 && "No legal plays found");
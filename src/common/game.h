@@ -13,6 +13,14 @@ int apply_bid(State *s, UC bid);
 int legal_play(State *s, unsigned char *o);
 void apply_play(State *sp, UC action);
 
+// Legal action sets as bitmasks
+// - Bits 0-3: bids 0-3; bits 4-7: TH, TJ, TL, TG; bits 8-9: OP, ON
+// - legal_bid and legal_play list actions in bit order, so equal masks mean
+//   equal action arrays
+uint16_t action_bit(UC action);
+uint16_t action_mask(const UC *actions, int n);
+void action_order(const UC *actions, int n, UC order[MAX_ACTIONS]);
+
 // Helper functions for card play
 bool is_legal_play(State *s, Card c);
 bool match_card_to_action(Card c, UC action, UC trump);
@@ -0,0 +1,65 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#ifndef KEY_H
+#define KEY_H
+
+#include "types.h"
+
+// Word-wise key operations
+// - A Key is two 64-bit words; bytes KEY_BYTES..15 are always zero
+// - Ordering matches memcmp over the key bytes: each word is compared as a
+//   big-endian integer (a byte swap per word on little-endian hosts)
+// - Strategy and checkpoint files store KEY_BYTES bytes; key_from_bits widens them
+
+// Forced inline: these sit in the innermost loops, and the default build is unoptimized
+#define KEY_INLINE static inline __attribute__((always_inline))
+
+// KEY_TAIL_WORD drops the bytes the two overlapping loads in key_from_bits share
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define KEY_ORDER_WORD(x) __builtin_bswap64(x)
+#define KEY_TAIL_WORD(x) ((x) >> (8 * (16 - KEY_BYTES)))
+#else
+#define KEY_ORDER_WORD(x) (x)
+#define KEY_TAIL_WORD(x) ((x) << (8 * (16 - KEY_BYTES)))
+#endif
+
+// Unaligned word view of file records (a plain load even in the -O0 build)
+typedef uint64_t key_word_unaligned __attribute__((aligned(1), may_alias));
+
+// Key from the KEY_BYTES bytes of a file record
+// - Two 8-byte loads (bytes 0-7 and KEY_BYTES-8 to KEY_BYTES-1), no byte copies
+KEY_INLINE Key key_from_bits(const UC *bits)
+{
+    uint64_t head = *(const key_word_unaligned *)bits;
+    uint64_t tail = *(const key_word_unaligned *)(bits + KEY_BYTES - 8);
+    Key k;
+    k.w[0] = head;
+    k.w[1] = KEY_TAIL_WORD(tail);
+    return k;
+}
+
+KEY_INLINE bool key_equal(const Key *a, const Key *b)
+{
+    return ((a->w[0] ^ b->w[0]) | (a->w[1] ^ b->w[1])) == 0;
+}
+
+// <0, 0, >0 as memcmp over the key bytes
+KEY_INLINE int key_cmp(const Key *a, const Key *b)
+{
+    if (a->w[0] != b->w[0])
+        return KEY_ORDER_WORD(a->w[0]) < KEY_ORDER_WORD(b->w[0]) ? -1 : 1;
+    if (a->w[1] != b->w[1])
+        return KEY_ORDER_WORD(a->w[1]) < KEY_ORDER_WORD(b->w[1]) ? -1 : 1;
+    return 0;
+}
+
+// Multiply-fold: 64x64->128 product of the two salted words, high ^ low
+// (mul-fold in ct-hashb; spreads real keys as well as FNV-1a at a fraction of the cost)
+KEY_INLINE unsigned int key_hash(const Key *k)
+{
+    __uint128_t m = (__uint128_t)(k->w[0] ^ 0xa0761d6478bd642fULL) * (k->w[1] ^ 0xe7037ed1a0b428dbULL);
+    uint64_t h = (uint64_t)m ^ (uint64_t)(m >> 64);
+    return (unsigned int)(h ^ (h >> 32));
+}
+
+#endif // KEY_H
@@ -0,0 +1,159 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include "prof.h"
+
+#ifdef PROFILE
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+_Thread_local ProfThread *prof_tls = NULL;
+
+static pthread_mutex_t prof_lock = PTHREAD_MUTEX_INITIALIZER;
+static ProfThread *prof_threads = NULL;
+static int prof_thread_count = 0;
+
+// Thread exit hands the record back, so training segments (one set of threads
+// each) reuse records and the count is the most threads alive at once
+static pthread_key_t prof_key;
+static pthread_once_t prof_key_once = PTHREAD_ONCE_INIT;
+
+static void prof_release(void *arg)
+{
+    ProfThread *t = (ProfThread *)arg;
+    pthread_mutex_lock(&prof_lock);
+    t->in_use = false;
+    pthread_mutex_unlock(&prof_lock);
+}
+
+// Tick rate, from ticks and wall time between the first registration and the report
+static uint64_t prof_tick0;
+static double prof_time0;
+static bool prof_armed;         // Exit report registered (a forked child inherits it)
+
+static double prof_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Only the forking thread lives on in a child: it keeps its record, zeroed, and
+// the others are dropped, so the child reports its own work only
+static void prof_fork_child(void)
+{
+    pthread_mutex_init(&prof_lock, NULL);
+    ProfThread *t = prof_threads;
+    while (t) {
+        ProfThread *next = t->next;
+        if (t != prof_tls) free(t);
+        t = next;
+    }
+    prof_threads = prof_tls;
+    prof_thread_count = prof_tls ? 1 : 0;
+    if (prof_tls) {
+        memset(prof_tls->cycles, 0, sizeof(prof_tls->cycles));
+        memset(prof_tls->calls, 0, sizeof(prof_tls->calls));
+        memset(prof_tls->nodes, 0, sizeof(prof_tls->nodes));
+        prof_tls->next = NULL;
+    }
+    prof_tick0 = prof_ticks();
+    prof_time0 = prof_now();
+}
+
+static void prof_make_key(void)
+{
+    pthread_key_create(&prof_key, prof_release);
+    pthread_atfork(NULL, NULL, prof_fork_child);
+}
+
+static const char *prof_names[PROF_COUNT] = {
+    "build_key", "get_or_create", "legal_bid", "legal_play", "score", "key compare", "find_node"
+};
+
+static void prof_report(void)
+{
+    if (prof_thread_count == 0) return;
+    double secs = prof_now() - prof_time0;
+    double ticks_per_ns = (secs > 0) ? (prof_ticks() - prof_tick0) / (secs * 1e9) : 1.0;
+    uint64_t cycles[PROF_COUNT] = {0}, calls[PROF_COUNT] = {0}, nodes[2][HAND_SIZE] = {{0}};
+
+    pthread_mutex_lock(&prof_lock);
+    for (ProfThread *t = prof_threads; t; t = t->next) {
+        for (int i = 0; i < PROF_COUNT; i++) {
+            cycles[i] += t->cycles[i];
+            calls[i] += t->calls[i];
+        }
+        for (int s = 0; s < 2; s++)
+            for (int k = 0; k < HAND_SIZE; k++)
+                nodes[s][k] += t->nodes[s][k];
+    }
+
+    fprintf(stderr, "\n=== Profile of pid %d (%d threads, %.2f ticks/ns, cycles include callees) ===\n",
+            (int)getpid(), prof_thread_count, ticks_per_ns);
+    fprintf(stderr, "%-14s %14s %14s %10s %10s\n", "function", "calls", "Mcycles", "cyc/call", "ms");
+    for (int i = 0; i < PROF_COUNT; i++) {
+        if (calls[i] == 0) continue;
+        fprintf(stderr, "%-14s %14lu %14.1f %10.1f %10.1f\n", prof_names[i], (unsigned long)calls[i],
+                cycles[i] / 1e6, (double)cycles[i] / calls[i], cycles[i] / ticks_per_ns / 1e6);
+    }
+
+    uint64_t total = 0;
+    for (int s = 0; s < 2; s++)
+        for (int k = 0; k < HAND_SIZE; k++)
+            total += nodes[s][k];
+    if (total > 0) {
+        fprintf(stderr, "Tree nodes by depth (%lu):\n", (unsigned long)total);
+        fprintf(stderr, "  bid:       %lu\n", (unsigned long)nodes[BID][0]);
+        for (int k = 0; k < HAND_SIZE; k++)
+            fprintf(stderr, "  trick %d:   %lu\n", k, (unsigned long)nodes[PLAY][k]);
+    }
+
+    int n = prof_thread_count;
+    for (ProfThread *t = prof_threads; t; t = t->next) {
+        n--;
+        if (t->calls[PROF_GET_OR_CREATE] == 0) continue;
+        fprintf(stderr, "  thread %d: %lu get_or_create, %.1f Mcycles\n", n,
+                (unsigned long)t->calls[PROF_GET_OR_CREATE], t->cycles[PROF_GET_OR_CREATE] / 1e6);
+    }
+    pthread_mutex_unlock(&prof_lock);
+}
+
+// Report now, for a process that ends with _exit (a forked child)
+void prof_flush(void)
+{
+    prof_report();
+    fflush(stderr);
+}
+
+// Give the calling thread its counters, reusing a record from a finished thread
+// when there is one; the first registration arms the exit report
+ProfThread *prof_register(void)
+{
+    pthread_once(&prof_key_once, prof_make_key);
+
+    pthread_mutex_lock(&prof_lock);
+    ProfThread *t = prof_threads;
+    while (t && t->in_use) t = t->next;
+    if (!t) {
+        t = aligned_alloc(_Alignof(ProfThread), sizeof(ProfThread));
+        memset(t, 0, sizeof(*t));
+        if (prof_thread_count == 0) {
+            prof_tick0 = prof_ticks();
+            prof_time0 = prof_now();
+            if (!prof_armed) atexit(prof_report);
+            prof_armed = true;
+        }
+        t->next = prof_threads;
+        prof_threads = t;
+        prof_thread_count++;
+    }
+    t->in_use = true;
+    pthread_mutex_unlock(&prof_lock);
+
+    pthread_setspecific(prof_key, t);
+    prof_tls = t;
+    return t;
+}
+
+#endif // PROFILE
@@ -0,0 +1,118 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#ifndef PROF_H
+#define PROF_H
+
+#include "types.h"
+#include "key.h"
+
+// Hot-path profiler, enabled with make PROFILE=1 (compiles to nothing otherwise)
+// - PROF_SCOPE(id) at the top of a function counts the call and its cycles
+//   (inclusive of callees) until the function returns, whichever return it takes
+// - PROF_NODE(stage, trick) counts a tree node by stage and trick number
+// - PROF_KEY_EQUAL and PROF_KEY_CMP time key comparisons
+// - Counters are per thread, each on its own cache lines, registered on first use
+//   and summed into a report on stderr at process exit
+// - A forked child starts from zeroed counters; PROF_FLUSH() prints its report
+//   before _exit, which skips the exit report
+#ifdef PROFILE
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t prof_ticks(void) { return __rdtsc(); }
+#else
+#include <time.h>
+static inline uint64_t prof_ticks(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+typedef enum {
+    PROF_BUILD_KEY,
+    PROF_GET_OR_CREATE,
+    PROF_LEGAL_BID,
+    PROF_LEGAL_PLAY,
+    PROF_SCORE,
+    PROF_KEY_CMP,
+    PROF_FIND_NODE,
+    PROF_COUNT
+} ProfId;
+
+typedef struct ProfThread {
+    _Alignas(64) uint64_t cycles[PROF_COUNT];
+    uint64_t calls[PROF_COUNT];
+    uint64_t nodes[2][HAND_SIZE];   // [stage][trick_num]
+    bool in_use;                    // Owned by a live thread; free records are reused
+    struct ProfThread *next;
+} ProfThread;
+
+typedef struct {
+    ProfId id;
+    uint64_t t0;
+} ProfScope;
+
+extern _Thread_local ProfThread *prof_tls;
+ProfThread *prof_register(void);
+void prof_flush(void);
+
+static inline ProfThread *prof_thread(void)
+{
+    return prof_tls ? prof_tls : prof_register();
+}
+
+static inline ProfScope prof_scope_begin(ProfId id)
+{
+    return (ProfScope){ id, prof_ticks() };
+}
+
+static inline void prof_scope_end(ProfScope *s)
+{
+    ProfThread *t = prof_thread();
+    t->cycles[s->id] += prof_ticks() - s->t0;
+    t->calls[s->id]++;
+}
+
+static inline void prof_key_cmp_end(uint64_t t0)
+{
+    ProfThread *t = prof_thread();
+    t->cycles[PROF_KEY_CMP] += prof_ticks() - t0;
+    t->calls[PROF_KEY_CMP]++;
+}
+
+static inline bool prof_key_equal(const Key *a, const Key *b)
+{
+    uint64_t t0 = prof_ticks();
+    bool r = key_equal(a, b);
+    prof_key_cmp_end(t0);
+    return r;
+}
+
+static inline int prof_key_cmp(const Key *a, const Key *b)
+{
+    uint64_t t0 = prof_ticks();
+    int r = key_cmp(a, b);
+    prof_key_cmp_end(t0);
+    return r;
+}
+
+#define PROF_SCOPE(id) \
+    ProfScope prof_scope_ __attribute__((cleanup(prof_scope_end))) = prof_scope_begin(id)
+#define PROF_NODE(stage, trick) (prof_thread()->nodes[(stage) & 1][(trick) % HAND_SIZE]++)
+#define PROF_KEY_EQUAL(a, b) prof_key_equal((a), (b))
+#define PROF_KEY_CMP(a, b) prof_key_cmp((a), (b))
+#define PROF_FLUSH() prof_flush()
+
+#else
+
+#define PROF_SCOPE(id) do { } while (0)
+#define PROF_NODE(stage, trick) do { } while (0)
+#define PROF_KEY_EQUAL(a, b) key_equal((a), (b))
+#define PROF_KEY_CMP(a, b) key_cmp((a), (b))
+#define PROF_FLUSH() do { } while (0)
+
+#endif // PROFILE
+
+#endif // PROF_H
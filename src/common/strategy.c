@@ -3,10 +3,13 @@
 #include "strategy.h"
 #include "abstraction.h"
 #include "util.h"
+#include "prof.h"
+#include "key.h"
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <math.h>
 
 // Load strategy from binary file via mmap — zero-copy, no malloc.
 // Supports files larger than available RAM; OS pages in only what's needed.
@@ -55,6 +58,7 @@ int find_node(Strat *strat, long count, Key *key)
 
 // Function to perform binary search
 int find_node(Strat_255 *strat, long qty, Key *t) {
+    PROF_SCOPE(PROF_FIND_NODE);
     int left = 0;
     int right = qty - 1;
 
@@ -62,11 +66,13 @@ int find_node(Strat_255 *strat, long qty, Key *t) {
         int mid = left + (right - left) / 2; // Calculate middle index
 
         // If the target is found at the middle
-        if (memcmp(&strat[mid].bits,t,sizeof(Key)) == 0) {
+        Key mk = key_from_bits(strat[mid].bits);
+        int cmp = PROF_KEY_CMP(&mk, t);
+        if (cmp == 0) {
             return mid;
         }
         // If the target is greater than the middle element, search in the right half
-        else if (memcmp(&strat[mid].bits,t,sizeof(Key)) < 0) {
+        else if (cmp < 0) {
             left = mid + 1;
         }
         // If the target is smaller than the middle element, search in the left half
@@ -80,50 +86,54 @@ int find_node(Strat_255 *strat, long qty, Key *t) {
 }
 
 
-bool is_valid_play_action(State *s, UC action)
+// Binary search for the node with this key and legal action mask
+// - Records with equal keys are ordered by mask (compare_keys)
+int find_node_mask(Strat_255 *strat, long qty, Key *t, uint16_t mask)
 {
-    UC valid_actions[MAX_ACTIONS];
-    UC valid_cnt = legal_play(s, valid_actions);
-    for (int i = 0; i < valid_cnt; i++) {
-        if (valid_actions[i] == action) {
-            return true;
-        }
+    int left = 0;
+    int right = qty - 1;
+
+    while (left <= right) {
+        int mid = left + (right - left) / 2;
+        Key mk = key_from_bits(strat[mid].bits);
+        int cmp = PROF_KEY_CMP(&mk, t);
+        if (cmp == 0) cmp = (int)strat[mid].mask - (int)mask;
+        if (cmp == 0)
+            return mid;
+        else if (cmp < 0)
+            left = mid + 1;
+        else
+            right = mid - 1;
     }
-    return false;
+    return -1;
 }
 
-bool is_valid_bid_action(State *s, UC action)
+// Node for the state: exact (key, legal mask) match, else any node with the key
+static int lookup_state(Strat_255 *strat, long count, State *s, uint16_t legal)
 {
-    UC valid_actions[MAX_ACTIONS];
-    UC valid_cnt = legal_bid(s, valid_actions);
-    for (int i = 0; i < valid_cnt; i++) {
-        if (valid_actions[i] == action) {
-            return true;
-        }
-    }
-    return false;
+    Key k = build_key(s);
+    int idx = find_node_mask(strat, count, &k, legal);
+    return (idx >= 0) ? idx : find_node(strat, count, &k);
 }
 
 // Get best action from strategy for current state
 // Returns action code or 0xff if no valid action found, otherwise returns the action with the highest probability
 UC get_best_action(Strat_255 *strat, long count, State *s)
 {
-    // Build key from current state
-    Key k = build_key(s);
-
-    // Find node
-    int idx = find_node(strat, count, &k);
+    UC actions[MAX_ACTIONS];
+    int n = (s->stage == BID) ? legal_bid(s, actions) : legal_play(s, actions);
+    uint16_t legal = action_mask(actions, n);
+    int idx = lookup_state(strat, count, s, legal);
     if (idx < 0) {
         return 0xff; // Invalid action marker
     }
 
-    // Find action with highest probability — dequantize only for this node
+    // Find the legal action with highest probability — dequantize only for this node
     float best_prob = -1.0f;
     UC best_action = 0xff;
 
     for (int i = 0; i < strat[idx].action_count; i++) {
-        if ((s->stage == 1 && is_valid_play_action(s, strat[idx].action[i])) ||
-            (s->stage == 0 && is_valid_bid_action(s, strat[idx].action[i]))) {
+        if (action_bit(strat[idx].action[i]) & legal) {
             float prob = strat[idx].s255[i] / 255.0f;
             if (prob > best_prob) {
                 best_prob = prob;
@@ -135,8 +145,91 @@ UC get_best_action(Strat_255 *strat, long count, State *s)
     return best_action;
 }
 
+// Get the strategy's probabilities for the legal actions of the current state
+// - actions are the state's legal actions as legal_bid / legal_play list them;
+//   probs[i] belongs to actions[i]; legal actions missing from the node get 0
+// - Returns false (and a uniform distribution) if the key is not in the strategy or
+//   the node gives the legal actions no weight
+bool get_action_probs(Strat_255 *strat, long count, State *s, const UC actions[], int n, float probs[])
+{
+    uint16_t legal = action_mask(actions, n);
+    int idx = lookup_state(strat, count, s, legal);
+
+    // Actions are in bit order, so an action's index is the number of legal bits below it
+    float total = 0.0f;
+    memset(probs, 0, n * sizeof(float));
+    if (idx >= 0) {
+        for (int j = 0; j < strat[idx].action_count; j++) {
+            uint16_t bit = action_bit(strat[idx].action[j]);
+            if (!(bit & legal)) continue;
+            probs[__builtin_popcount(legal & (bit - 1))] = strat[idx].s255[j] / 255.0f;
+            total += strat[idx].s255[j] / 255.0f;
+        }
+    }
+
+    if (total <= 0.0f) {
+        for (int i = 0; i < n; i++)
+            probs[i] = 1.0f / n;
+        return false;
+    }
+    for (int i = 0; i < n; i++)
+        probs[i] /= total;
+    return true;
+}
+
 // Unmap strategy — count must match the value returned by load_strategy
 void free_strategy(Strat_255 *strat, long count)
 {
     munmap(strat, (size_t)count * sizeof(Strat_255));
 }
+
+// Compare two Strat records by key (for qsort and merge comparison)
+// - If key is equal, order by legal action mask
+// - Need to include to separate nodes with different actions
+int compare_keys(const void *a, const void *b)
+{
+    const Strat *sa = (const Strat *)a;
+    const Strat *sb = (const Strat *)b;
+    Key ka = key_from_bits(sa->bits), kb = key_from_bits(sb->bits);
+    int _1st = key_cmp(&ka, &kb);
+    if (_1st != 0) return _1st;
+    return (int)sa->mask - (int)sb->mask;
+}
+
+// Put a Strat's actions (and strategy) in bit order and set its mask
+// - Files from older builds may list actions in hand order and have no mask
+// - Returns true if the record changed
+bool order_strat(Strat *st)
+{
+    Strat in = *st;
+    UC order[MAX_ACTIONS];
+    action_order(in.action, in.action_count, order);
+    for (int j = 0; j < in.action_count; j++) {
+        st->action[j] = in.action[order[j]];
+        st->strategy[j] = in.strategy[order[j]];
+    }
+    st->mask = action_mask(st->action, st->action_count);
+    return st->mask != in.mask || memcmp(st->action, in.action, MAX_ACTIONS) != 0 ||
+           memcmp(st->strategy, in.strategy, sizeof(in.strategy)) != 0;
+}
+
+// Quantize strategy to reduce memory load when reading into eval
+// - This is a lossy operation, but it allows us to read the merged file into eval without blowing up memory
+// - We can adjust the quantization level (e.g. 255) to balance precision vs memory usage
+// - We also need to copy the key and action data, since those are needed for eval and are not quantized
+void quantize_output(Strat *st, Strat_255 *st2, int action_count) {
+    memset(st2, 0, sizeof(Strat_255));
+    memcpy(st2->bits, st->bits, KEY_BYTES);
+    st2->action_count = st->action_count;
+    st2->mask = st->mask;
+    memcpy(st2->action, st->action, action_count); 
+    for (int i = 0; i < action_count; i++) {
+        if (isnan(st->strategy[i]) || st->strategy[i] < 0.0f) {
+            st2->s255[i] = 0;
+        } else if (st->strategy[i] > 1.0f) {
+            st2->s255[i] = 255;
+        } else {
+            st2->s255[i] = (uint8_t)(st->strategy[i] * 255.0f + 0.5f); // Round to nearest
+        }
+    }       
+}
@@ -9,7 +9,14 @@
 // Strategy loading and querying
 Strat_255 *load_strategy(const char *filename, long *count);
 int find_node(Strat_255 *strat, long count, Key *key);
+int find_node_mask(Strat_255 *strat, long count, Key *key, uint16_t mask);
 UC get_best_action(Strat_255 *strat, long count, State *s);
+bool get_action_probs(Strat_255 *strat, long count, State *s, const UC actions[], int n, float probs[]);
 void free_strategy(Strat_255 *strat, long count);
 
+// Strat ordering and quantization (shared by ct sorted output and ct-kwayp)
+int compare_keys(const void *a, const void *b);
+void quantize_output(Strat *st, Strat_255 *st2, int action_count);
+bool order_strat(Strat *st);
+
 #endif // STRATEGY_H
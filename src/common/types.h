@@ -122,37 +122,67 @@ typedef struct {
     char t_score[PLAYERS];       // Total score (can be negative if set)
 } State;
 
-// Key structure (14 bytes for state abstraction)
+// Counter-based random stream (SplitMix64 state; see rng_init in util.c)
 typedef struct {
-    UC bits[14];
+    uint64_t state;
+} Rng;
+
+// Key bytes used by the abstraction (and stored in strategy and checkpoint files)
+#define KEY_BYTES 14
+
+// Key structure (14 bytes for state abstraction, padded to 16)
+// - Handled as two 64-bit words for hashing and comparison (see key.h)
+typedef union {
+    UC bits[16];
+    uint64_t w[2];
 } Key;
 
 // CFR Node structure
+// - action_count, mask and dirty share one 16-bit word after action[], so the node
+//   has no padding: 72 bytes (80-byte heap chunk) with SAMPLED_AVG, 88 without
+// - dirty marks a node updated since its last consumer took it: the --procs sync in a
+//   worker, or the previous --snapshot-delta snapshot (see cfr_track_dirty). Each
+//   consumer clears the flags it takes, so ct rejects --procs with snapshot options
+//   and a run never has both clearing each other's flags
 typedef struct Node {
     Key key;                        // State abstraction key
-    UC action_count;                // Number of legal actions
     UC action[MAX_ACTIONS];         // Legal actions
+    uint16_t mask : 12;             // Legal action set (action_mask uses bits 0-9)
+    uint16_t action_count : 3;      // Number of legal actions
+    uint16_t dirty : 1;             // Updated since the last sync or delta snapshot
     float regret_sum[MAX_ACTIONS];  // Cumulative regrets
+#ifdef SAMPLED_AVG
+    uint16_t avg_count[MAX_ACTIONS]; // Sampled action counts (for averaging; see cfr.c)
+#else
     float strategy_sum[MAX_ACTIONS]; // Cumulative strategy (for averaging)
+#endif
     int visits;                     // Number of times visited
     struct Node *next;              // For hash table chaining
 } Node;
 
+#ifdef SAMPLED_AVG
+_Static_assert(sizeof(Node) == 72, "SAMPLED_AVG Node must stay within an 80-byte heap chunk");
+#else
+_Static_assert(sizeof(Node) == 88, "Node must stay within a 96-byte heap chunk");
+#endif
+
 // Strategy structure (for serialization/loading)
 // - Output from training, input to kwayp merge
 typedef struct {
-    UC bits[sizeof(Key)];           // Key
+    UC bits[KEY_BYTES];             // Key
     UC action_count;                // Number of actions
-    UC action[MAX_ACTIONS];         // Actions
+    UC action[MAX_ACTIONS];         // Actions (in action_mask bit order)
+    uint16_t mask;                  // Legal action set (fills padding; recomputed on load)
     float strategy[MAX_ACTIONS];    // Average strategy
 } Strat;
 
 // Strategy structure with 255 ranks (for memory-efficient eval loading)
 // - Output from kwayp, input to eval
 typedef struct {
-    UC bits[sizeof(Key)];           // Key
+    UC bits[KEY_BYTES];             // Key
     UC action_count;                // Number of actions
-    UC action[MAX_ACTIONS];         // Actions
+    UC action[MAX_ACTIONS];         // Actions (in action_mask bit order)
+    uint16_t mask;                  // Legal action set
     UC s255[MAX_ACTIONS];           // Float broken down into 255 ranks to save memory in eval load
 } Strat_255;
 
@@ -92,12 +92,12 @@ static void dump_hex(const void *data, size_t len)
     if (len % 16 != 0) printf("\n");
 }
 
-// Decode and print the 13-byte key
+// Decode and print the KEY_BYTES-byte key
 static void print_key_decoded(const UC *bits)
 {
     // --- binary ---
     printf("Key binary:\n");
-    for (int i = 0; i < (int)sizeof(Key); i++) {
+    for (int i = 0; i < KEY_BYTES; i++) {
         printf("  [%2d] ", i);
         print_byte_bin(bits[i]);
         printf("\n");
@@ -105,7 +105,7 @@ static void print_key_decoded(const UC *bits)
 
     // --- hex ---
     printf("Key hex:\n  ");
-    for (int i = 0; i < (int)sizeof(Key); i++)
+    for (int i = 0; i < KEY_BYTES; i++)
         printf("%02x ", bits[i]);
     printf("\n");
 
@@ -169,6 +169,36 @@ unsigned char get_random(unsigned char min, unsigned char max, unsigned int *see
     return min + ((*seed >> 16) % (max - min + 1));
 }
 
+// SplitMix64 finalizer: full-avalanche 64-bit mix
+static inline uint64_t mix64(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Seed a stream from (seed, stream) — e.g. (base seed, deal index)
+// - Both inputs pass through the mixer, so adjacent deal indices start far apart
+//   instead of on neighbouring points of one sequence as with seed + i under the LCG
+void rng_init(Rng *r, uint64_t seed, uint64_t stream)
+{
+    r->state = mix64(seed + 0x9e3779b97f4a7c15ull) ^ mix64(stream * 0xd1b54a32d192ed03ull + 1);
+}
+
+// SplitMix64 step: Weyl counter plus mix
+uint64_t rng_next(Rng *r)
+{
+    r->state += 0x9e3779b97f4a7c15ull;
+    return mix64(r->state);
+}
+
+// Uniform value in [0, n) by multiply-shift of the upper 32 bits (no modulo)
+// - Bias is at most n / 2^32, negligible for n <= DECK_SIZE
+UC rng_bounded(Rng *r, UC n)
+{
+    return (UC)(((rng_next(r) >> 32) * n) >> 32);
+}
+
 // Print a single card
 void print_card(Card c)
 {
@@ -251,31 +281,37 @@ void print_node(Node *n)
     printf("Node raw bytes (binary):\n");
     printf("  key[%zu]:\n", sizeof(Key));
     dump_binary(&n->key, sizeof(Key), 0);
-    printf("  action_count:\n");
-    dump_binary(&n->action_count, 1, sizeof(Key));
     printf("  action[%d]:\n", MAX_ACTIONS);
-    dump_binary(n->action, MAX_ACTIONS, sizeof(Key) + 1);
+    dump_binary(n->action, MAX_ACTIONS, offsetof(Node, action));
+    printf("  action_count %d, mask 0x%03x, dirty %d (packed 16-bit word)\n",
+           n->action_count, n->mask, n->dirty);
     printf("  regret_sum[%d] (floats):\n", MAX_ACTIONS);
-    dump_binary(n->regret_sum, MAX_ACTIONS * sizeof(float),
-                sizeof(Key) + 1 + MAX_ACTIONS);
+    dump_binary(n->regret_sum, MAX_ACTIONS * sizeof(float), offsetof(Node, regret_sum));
+#ifdef SAMPLED_AVG
+    printf("  avg_count[%d] (uint16):\n", MAX_ACTIONS);
+    dump_binary(n->avg_count, sizeof(n->avg_count), offsetof(Node, avg_count));
+#else
     printf("  strategy_sum[%d] (floats):\n", MAX_ACTIONS);
-    dump_binary(n->strategy_sum, MAX_ACTIONS * sizeof(float),
-                sizeof(Key) + 1 + MAX_ACTIONS + MAX_ACTIONS * sizeof(float));
+    dump_binary(n->strategy_sum, MAX_ACTIONS * sizeof(float), offsetof(Node, strategy_sum));
+#endif
     printf("  visits (int):\n");
-    dump_binary(&n->visits, sizeof(int),
-                sizeof(Key) + 1 + MAX_ACTIONS + 2 * MAX_ACTIONS * sizeof(float));
+    dump_binary(&n->visits, sizeof(int), offsetof(Node, visits));
 
     // Raw hex of struct fields
     printf("Node raw bytes (hex):\n");
     printf("  key:         "); dump_hex(&n->key, sizeof(Key));
-    printf("  action_count:"); dump_hex(&n->action_count, 1);
     printf("  action:      "); dump_hex(n->action, MAX_ACTIONS);
+    printf("  packed word: "); dump_hex((const UC *)n->action + MAX_ACTIONS, sizeof(uint16_t));
     printf("  regret_sum:  "); dump_hex(n->regret_sum, MAX_ACTIONS * sizeof(float));
+#ifdef SAMPLED_AVG
+    printf("  avg_count:   "); dump_hex(n->avg_count, sizeof(n->avg_count));
+#else
     printf("  strategy_sum:"); dump_hex(n->strategy_sum, MAX_ACTIONS * sizeof(float));
+#endif
     printf("  visits:      "); dump_hex(&n->visits, sizeof(int));
 
-    // Action count and decoded actions
-    printf("Action count: %d\n", n->action_count);
+    // Action count, mask and decoded actions
+    printf("Action count: %d (mask 0x%03x)\n", n->action_count, n->mask);
     printf("Actions:      ");
     for (int i = 0; i < n->action_count; i++)
         printf("[%02x=%s] ", n->action[i], action_mnemonic(n->action[i]));
@@ -289,8 +325,13 @@ void print_node(Node *n)
 
     // Strategy sum
     printf("Strategy sum: ");
-    for (int i = 0; i < n->action_count; i++)
+    for (int i = 0; i < n->action_count; i++) {
+#ifdef SAMPLED_AVG
+        printf("[%s: %8u] ", action_mnemonic(n->action[i]), n->avg_count[i]);
+#else
         printf("[%s: %8.4f] ", action_mnemonic(n->action[i]), n->strategy_sum[i]);
+#endif
+    }
     printf("\n");
 
     printf("Visits: %d\n", n->visits);
@@ -309,25 +350,27 @@ void print_strategy(Strat *s)
 
     // Raw binary of struct fields
     printf("Strat raw bytes (binary):\n");
-    printf("  bits[%zu]:\n", sizeof(Key));
-    dump_binary(s->bits, sizeof(Key), 0);
+    printf("  bits[%d]:\n", KEY_BYTES);
+    dump_binary(s->bits, KEY_BYTES, 0);
     printf("  action_count:\n");
-    dump_binary(&s->action_count, 1, sizeof(Key));
+    dump_binary(&s->action_count, 1, KEY_BYTES);
     printf("  action[%d]:\n", MAX_ACTIONS);
-    dump_binary(s->action, MAX_ACTIONS, sizeof(Key) + 1);
+    dump_binary(s->action, MAX_ACTIONS, KEY_BYTES + 1);
+    printf("  mask:\n");
+    dump_binary(&s->mask, sizeof(s->mask), offsetof(Strat, mask));
     printf("  strategy[%d] (floats):\n", MAX_ACTIONS);
-    dump_binary(s->strategy, MAX_ACTIONS * sizeof(float),
-                sizeof(Key) + 1 + MAX_ACTIONS);
+    dump_binary(s->strategy, MAX_ACTIONS * sizeof(float), offsetof(Strat, strategy));
 
     // Raw hex of struct fields
     printf("Strat raw bytes (hex):\n");
-    printf("  bits:        "); dump_hex(s->bits, sizeof(Key));
+    printf("  bits:        "); dump_hex(s->bits, KEY_BYTES);
     printf("  action_count:"); dump_hex(&s->action_count, 1);
     printf("  action:      "); dump_hex(s->action, MAX_ACTIONS);
+    printf("  mask:        "); dump_hex(&s->mask, sizeof(s->mask));
     printf("  strategy:    "); dump_hex(s->strategy, MAX_ACTIONS * sizeof(float));
 
-    // Action count and decoded actions
-    printf("Action count: %d\n", s->action_count);
+    // Action count, mask and decoded actions
+    printf("Action count: %d (mask 0x%03x)\n", s->action_count, s->mask);
     printf("Actions:      ");
     for (int i = 0; i < s->action_count; i++)
         printf("[%02x=%s] ", s->action[i], action_mnemonic(s->action[i]));
@@ -353,24 +396,27 @@ void print_strategy_255(Strat_255 *s)
 
     // Raw binary of struct fields
     printf("Strat_255 raw bytes (binary):\n");
-    printf("  bits[%zu]:\n", sizeof(Key));
-    dump_binary(s->bits, sizeof(Key), 0);
+    printf("  bits[%d]:\n", KEY_BYTES);
+    dump_binary(s->bits, KEY_BYTES, 0);
     printf("  action_count:\n");
-    dump_binary(&s->action_count, 1, sizeof(Key));
+    dump_binary(&s->action_count, 1, KEY_BYTES);
     printf("  action[%d]:\n", MAX_ACTIONS);
-    dump_binary(s->action, MAX_ACTIONS, sizeof(Key) + 1);
+    dump_binary(s->action, MAX_ACTIONS, KEY_BYTES + 1);
+    printf("  mask:\n");
+    dump_binary(&s->mask, sizeof(s->mask), offsetof(Strat_255, mask));
     printf("  s255[%d]:\n", MAX_ACTIONS);
-    dump_binary(s->s255, MAX_ACTIONS, sizeof(Key) + 1 + MAX_ACTIONS);
+    dump_binary(s->s255, MAX_ACTIONS, offsetof(Strat_255, s255));
 
     // Raw hex of struct fields
     printf("Strat_255 raw bytes (hex):\n");
-    printf("  bits:        "); dump_hex(s->bits, sizeof(Key));
+    printf("  bits:        "); dump_hex(s->bits, KEY_BYTES);
     printf("  action_count:"); dump_hex(&s->action_count, 1);
     printf("  action:      "); dump_hex(s->action, MAX_ACTIONS);
+    printf("  mask:        "); dump_hex(&s->mask, sizeof(s->mask));
     printf("  s255:        "); dump_hex(s->s255, MAX_ACTIONS);
 
-    // Action count and decoded actions
-    printf("Action count: %d\n", s->action_count);
+    // Action count, mask and decoded actions
+    printf("Action count: %d (mask 0x%03x)\n", s->action_count, s->mask);
     printf("Actions:      ");
     for (int i = 0; i < s->action_count; i++)
         printf("[%02x=%s] ", s->action[i], action_mnemonic(s->action[i]));
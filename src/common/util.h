@@ -8,6 +8,12 @@
 // Random number generation
 unsigned char get_random(unsigned char min, unsigned char max, unsigned int *seed);
 
+// Counter-based generator for deals
+// - rng_init(seed, stream) gives every (seed, deal index) pair its own independent stream
+void rng_init(Rng *r, uint64_t seed, uint64_t stream);
+uint64_t rng_next(Rng *r);
+UC rng_bounded(Rng *r, UC n);
+
 // Debugging/logging helpers
 void print_card(Card c);
 void print_hand(Hand *h, int size);
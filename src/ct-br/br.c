@@ -0,0 +1,259 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include "br.h"
+#include "game.h"
+#include "deck.h"
+#include "util.h"
+#include "abstraction.h"
+#include "key.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Iterated best response within the abstraction
+// - The responder's information sets are the same (key, action set) pairs ct trains;
+//   the opponent plays the strategy's probabilities (uniform where the key is missing)
+// - A learning pass walks every deal with the responder exploring all of its actions
+//   and the opponent weighted by its strategy, adding opponent-reach weighted action
+//   values to each information set; br_update then picks the best action per set
+// - The key is imperfect recall, so one update is not an exact best response: values
+//   below a set depend on the responses chosen there. Passes are repeated until the
+//   responses stop changing
+// - Information sets without a response yet play the strategy itself
+
+#define BR_BUCKETS (1L << 22)
+#define LOCK_STRIPES 4096
+static pthread_mutex_t stripes[LOCK_STRIPES];
+
+static unsigned long br_hash(Key *k)
+{
+    return key_hash(k) % BR_BUCKETS;
+}
+
+int br_init(BrTable *t, Strat_255 *strat, long strat_count)
+{
+    t->strat = strat;
+    t->strat_count = strat_count;
+    t->nodes = 0;
+    t->buckets = calloc(BR_BUCKETS, sizeof(BrNode *));
+    if (!t->buckets) {
+        fprintf(stderr, "Error: Cannot allocate best-response table\n");
+        return 1;
+    }
+    for (int i = 0; i < LOCK_STRIPES; i++)
+        pthread_mutex_init(&stripes[i], NULL);
+    return 0;
+}
+
+void br_free(BrTable *t)
+{
+    for (long i = 0; i < BR_BUCKETS; i++) {
+        BrNode *cur = t->buckets[i];
+        while (cur) {
+            BrNode *next = cur->next;
+            free(cur);
+            cur = next;
+        }
+    }
+    free(t->buckets);
+    t->buckets = NULL;
+}
+
+// Find an information set; create it when create is set, otherwise may return NULL
+static BrNode *br_get(BrTable *t, Key *key, UC actions[], int n, bool create, unsigned long *bucket)
+{
+    uint16_t mask = action_mask(actions, n);
+    unsigned long idx = br_hash(key);
+    *bucket = idx;
+    pthread_mutex_lock(&stripes[idx % LOCK_STRIPES]);
+    BrNode *cur = t->buckets[idx];
+    while (cur) {
+        if (cur->mask == mask && key_equal(&cur->key, key))
+            break;
+        cur = cur->next;
+    }
+    if (!cur && create) {
+        cur = calloc(1, sizeof(BrNode));
+        if (!cur) {
+            fprintf(stderr, "Error: Out of memory creating best-response node\n");
+            exit(1);
+        }
+        cur->key = *key;
+        cur->action_count = n;
+        cur->mask = mask;
+        memcpy(cur->action, actions, n);
+        cur->best = BR_NONE;
+        cur->next = t->buckets[idx];
+        t->buckets[idx] = cur;
+    }
+    pthread_mutex_unlock(&stripes[idx % LOCK_STRIPES]);
+    return cur;
+}
+
+static void apply_action(State *sp, UC action)
+{
+    if (sp->stage == BID) {
+        apply_bid(sp, action);
+    } else {
+        UC card_index = bind_card_index_to_action(sp, action);
+        apply_play(sp, card_index);
+    }
+}
+
+typedef struct {
+    BrTable *table;
+    bool learn;
+    long found;
+    long missing;
+} Walk;
+
+// Value of the state for responder p; reach is the opponent's probability of getting here
+static double br_recurse(Walk *w, State *sp, int p, double reach)
+{
+    if (sp->hand_done) {
+        int payoff = score(sp);
+        return (p == 0) ? payoff : -payoff;
+    }
+
+    UC actions[MAX_ACTIONS];
+    int n = (sp->stage == BID) ? legal_bid(sp, actions) : legal_play(sp, actions);
+    float probs[MAX_ACTIONS];
+    double v[MAX_ACTIONS] = {0};
+
+    // Opponent: strategy-weighted average, skipping actions it never takes
+    if (sp->to_act != p) {
+        if (get_action_probs(w->table->strat, w->table->strat_count, sp, actions, n, probs))
+            w->found++;
+        else
+            w->missing++;
+        double value = 0.0;
+        for (int i = 0; i < n; i++) {
+            if (probs[i] <= 0.0f) continue;
+            State next = *sp;
+            apply_action(&next, actions[i]);
+            value += probs[i] * br_recurse(w, &next, p, reach * probs[i]);
+        }
+        return value;
+    }
+
+    Key k = build_key(sp);
+    unsigned long bucket;
+    BrNode *node = br_get(w->table, &k, actions, n, w->learn, &bucket);
+    // Nodes match on the mask, so their actions line up with actions[]
+    int choice = (node && node->best != BR_NONE) ? node->best : -1;
+
+    // Held-out play of a known response: one line only
+    if (!w->learn && choice >= 0) {
+        State next = *sp;
+        apply_action(&next, actions[choice]);
+        return br_recurse(w, &next, p, reach);
+    }
+
+    // No response yet: the responder plays the strategy here
+    if (choice < 0)
+        get_action_probs(w->table->strat, w->table->strat_count, sp, actions, n, probs);
+
+    double value = 0.0;
+    for (int i = 0; i < n; i++) {
+        if (!w->learn && probs[i] <= 0.0f) continue;
+        State next = *sp;
+        apply_action(&next, actions[i]);
+        v[i] = br_recurse(w, &next, p, reach);
+        if (choice < 0) value += probs[i] * v[i];
+    }
+    if (choice >= 0) value = v[choice];
+
+    if (w->learn) {
+        pthread_mutex_lock(&stripes[bucket % LOCK_STRIPES]);
+        for (int i = 0; i < n; i++)
+            node->value[i] += reach * v[i];
+        pthread_mutex_unlock(&stripes[bucket % LOCK_STRIPES]);
+    }
+    return value;
+}
+
+typedef struct {
+    BrTable *table;
+    unsigned int seed;
+    long first;
+    long deals;
+    bool learn;
+    atomic_long *next;
+    double (*deal_value)[PLAYERS];  // Per deal, so totals do not depend on the thread count
+    long found;
+    long missing;
+} PassThread;
+
+// Same deal setup as ct's train_deal
+static void *pass_thread(void *arg)
+{
+    PassThread *pt = (PassThread *)arg;
+    Walk w = { pt->table, pt->learn, 0, 0 };
+    long i;
+    while ((i = atomic_fetch_add(pt->next, 1)) < pt->deals) {
+        Rng rng;
+        rng_init(&rng, pt->seed, (uint64_t)(pt->first + i));
+
+        State s = {0};
+        s.seed = (unsigned int)rng_next(&rng);
+        s.dealer = rng_bounded(&rng, 2);
+        s.stage = BID;
+        s.to_act = 1 - s.dealer;
+        s.trump = PRE_TRUMP;
+
+        deal_hands(&s, &rng);
+
+        for (int p = 0; p < PLAYERS; p++)
+            pt->deal_value[i][p] = br_recurse(&w, &s, p, 1.0);
+    }
+    pt->found = w.found;
+    pt->missing = w.missing;
+    return NULL;
+}
+
+void br_pass(BrTable *t, unsigned int seed, long first, long deals, int threads, bool learn, BrPass *out)
+{
+    memset(out, 0, sizeof(BrPass));
+    double (*deal_value)[PLAYERS] = calloc(deals, sizeof(*deal_value));
+    pthread_t *tids = malloc(threads * sizeof(pthread_t));
+    PassThread *pt = calloc(threads, sizeof(PassThread));
+    if (!deal_value || !tids || !pt) {
+        fprintf(stderr, "Error: Out of memory for %ld deals\n", deals);
+        exit(1);
+    }
+
+    atomic_long next = 0;
+    for (int i = 0; i < threads; i++) {
+        pt[i] = (PassThread){ t, seed, first, deals, learn, &next, deal_value, 0, 0 };
+        pthread_create(&tids[i], NULL, pass_thread, &pt[i]);
+    }
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+        out->lookups_found += pt[i].found;
+        out->lookups_missing += pt[i].missing;
+    }
+    for (long i = 0; i < deals; i++)
+        for (int p = 0; p < PLAYERS; p++)
+            out->value[p] += deal_value[i][p];
+
+    free(pt);
+    free(tids);
+    free(deal_value);
+}
+
+long br_update(BrTable *t)
+{
+    long changed = 0;
+    t->nodes = 0;
+    for (long i = 0; i < BR_BUCKETS; i++) {
+        for (BrNode *cur = t->buckets[i]; cur; cur = cur->next) {
+            t->nodes++;
+            UC best = 0;
+            for (int a = 1; a < cur->action_count; a++)
+                if (cur->value[a] > cur->value[best]) best = a;
+            if (best != cur->best) changed++;
+            cur->best = best;
+            memset(cur->value, 0, sizeof(cur->value));
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,49 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#ifndef BR_H
+#define BR_H
+
+#include "types.h"
+#include "strategy.h"
+
+// Best-response information set: an abstract key plus its legal action set
+typedef struct BrNode {
+    Key key;
+    UC action_count;
+    UC action[MAX_ACTIONS];
+    uint16_t mask;                  // Legal action set (action_mask)
+    UC best;                        // Index into action, or BR_NONE before the first update
+    double value[MAX_ACTIONS];      // Opponent-reach weighted action values, summed over deals
+    struct BrNode *next;
+} BrNode;
+
+#define BR_NONE 0xff
+
+// Best-response table and the strategy it responds to
+typedef struct {
+    Strat_255 *strat;
+    long strat_count;
+    BrNode **buckets;
+    long nodes;             // Information sets, as of the last br_update
+} BrTable;
+
+// Values of one pass over a deal range
+typedef struct {
+    double value[PLAYERS];  // Summed payoff of the best responder in each seat
+    long lookups_found;     // Opponent decisions found in the strategy
+    long lookups_missing;   // Opponent decisions played uniformly (key not in strategy)
+} BrPass;
+
+int br_init(BrTable *t, Strat_255 *strat, long strat_count);
+void br_free(BrTable *t);
+
+// One pass over deals [first, first + deals) with a responder in each seat
+// - learn: explore every responder action and accumulate action values
+// - !learn: play the current responses (held-out evaluation)
+void br_pass(BrTable *t, unsigned int seed, long first, long deals, int threads, bool learn, BrPass *out);
+
+// Point each information set at its best accumulated action, then clear the values
+// - Returns the number of information sets whose response changed
+long br_update(BrTable *t);
+
+#endif // BR_H
@@ -0,0 +1,100 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "types.h"
+#include "strategy.h"
+#include "br.h"
+
+#define DEFAULT_ITERATIONS 4
+
+// Monotonic wall clock in seconds
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Exploitability in points per hand: the mean of the two seats' best-response values
+static void print_pass(const char *label, BrPass *pass, long deals)
+{
+    double v0 = pass->value[0] / deals;
+    double v1 = pass->value[1] / deals;
+    long lookups = pass->lookups_found + pass->lookups_missing;
+    printf("%s: exploitability %.4f points/hand (P0 responder %+.4f, P1 responder %+.4f), "
+           "opponent coverage %.2f%%\n",
+           label, (v0 + v1) / 2.0, v0, v1,
+           lookups ? 100.0 * pass->lookups_found / lookups : 0.0);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 5 || argc > 7) {
+        fprintf(stderr, "Usage: %s <strategy_file> <deals> <threads> <seed> [iterations [heldout_deals]]\n", argv[0]);
+        fprintf(stderr, "  deals: sampled deals the best response is computed on\n");
+        fprintf(stderr, "  iterations: best-response passes (default %d; stops early once stable)\n", DEFAULT_ITERATIONS);
+        fprintf(stderr, "  heldout_deals: fresh deals the final response is scored on (default = deals, 0 = skip)\n");
+        fprintf(stderr, "  seed: 0 for random\n");
+        return 1;
+    }
+
+    const char *strategy_file = argv[1];
+    long deals = atol(argv[2]);
+    int threads = atoi(argv[3]);
+    unsigned int seed = (unsigned int)atol(argv[4]);
+    int iterations = (argc >= 6) ? atoi(argv[5]) : DEFAULT_ITERATIONS;
+    long heldout = (argc >= 7) ? atol(argv[6]) : deals;
+
+    if (deals <= 0 || threads <= 0 || iterations <= 0 || heldout < 0) {
+        fprintf(stderr, "Error: deals, threads and iterations must be positive\n");
+        return 1;
+    }
+    if (seed == 0) seed = (unsigned int)time(NULL);
+
+    printf("=== CT-BR Best Response ===\n");
+    printf("Strategy file: %s\n", strategy_file);
+    printf("Deals: %ld (held out: %ld)\n", deals, heldout);
+    printf("Threads: %d\n", threads);
+    printf("Seed: %u\n", seed);
+    printf("\n");
+
+    long strat_count = 0;
+    Strat_255 *strat = load_strategy(strategy_file, &strat_count);
+    if (!strat) {
+        return 1;
+    }
+    printf("\n");
+
+    BrTable table;
+    if (br_init(&table, strat, strat_count) != 0) {
+        free_strategy(strat, strat_count);
+        return 1;
+    }
+
+    // Learning passes: each scores the responses of the previous update
+    BrPass pass;
+    for (int it = 1; it <= iterations; it++) {
+        double start = now_seconds();
+        br_pass(&table, seed, 0, deals, threads, true, &pass);
+        long changed = br_update(&table);
+        char label[32];
+        snprintf(label, sizeof(label), "Pass %d", it);
+        print_pass(label, &pass, deals);
+        printf("        %ld information sets, %ld responses changed, %.2f seconds\n",
+               table.nodes, changed, now_seconds() - start);
+        if (changed == 0) break;
+    }
+
+    // Held-out deals follow the training deals in the same stream, so they never overlap
+    if (heldout > 0) {
+        br_pass(&table, seed, deals, heldout, threads, false, &pass);
+        print_pass("Held out", &pass, heldout);
+    }
+
+    br_free(&table);
+    free_strategy(strat, strat_count);
+    return 0;
+}
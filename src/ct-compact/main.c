@@ -0,0 +1,165 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "types.h"
+#include "key.h"
+
+// Folds a base snapshot and its delta snapshots (ct --snapshot-delta) into one full file
+// - Every input is sorted by key, then mask, with one record per information set,
+//   so a streaming merge needs one record per file in memory
+// - Where several files hold an information set, the last file on the command line wins
+
+typedef union {
+    Strat s;
+    Strat_255 q;
+} Record;
+
+typedef struct {
+    const char *name;
+    FILE *fp;
+    Record cur;
+    Key key;            // cur's key as words
+    uint16_t mask;      // cur's legal action mask
+    bool done;
+    long read;
+} Stream;
+
+static size_t record_size;
+static bool quantized;
+
+static int compare_heads(const Stream *a, const Stream *b)
+{
+    int c = key_cmp(&a->key, &b->key);
+    if (c != 0) return c;
+    return (int)a->mask - (int)b->mask;
+}
+
+// Read the next record; inputs must be strictly increasing, as ct writes them
+static int advance(Stream *s)
+{
+    Stream prev = *s;
+    if (fread(&s->cur, record_size, 1, s->fp) != 1) {
+        s->done = true;
+        return 0;
+    }
+    s->key = key_from_bits(s->cur.s.bits);
+    s->mask = quantized ? s->cur.q.mask : s->cur.s.mask;
+    s->read++;
+    if (s->read > 1 && compare_heads(&prev, s) >= 0) {
+        fprintf(stderr, "Error: %s is not sorted by key and mask (record %ld)\n", s->name, s->read);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s <format> <output_file> <base_file> [delta_file ...]\n", argv[0]);
+        fprintf(stderr, "  format: S = Strat, Q = Strat_255 (the --out-format of the run)\n");
+        fprintf(stderr, "  Later files override earlier ones; list deltas in snapshot order\n");
+        return 1;
+    }
+
+    char format = argv[1][0];
+    if (format == 'S' || format == 's') {
+        record_size = sizeof(Strat);
+        quantized = false;
+    } else if (format == 'Q' || format == 'q') {
+        record_size = sizeof(Strat_255);
+        quantized = true;
+    } else {
+        fprintf(stderr, "Error: Invalid format '%c'. Use S or Q.\n", format);
+        return 1;
+    }
+
+    const char *output_file = argv[2];
+    int n = argc - 3;
+    Stream *streams = calloc(n, sizeof(Stream));
+    if (!streams) {
+        fprintf(stderr, "Error: Cannot allocate stream array\n");
+        return 1;
+    }
+
+    printf("=== CT-COMPACT Snapshot Compaction ===\n");
+    printf("Output: %s\n", output_file);
+
+    int rc = 0;
+    for (int i = 0; i < n && rc == 0; i++) {
+        streams[i].name = argv[3 + i];
+        struct stat st;
+        if (stat(streams[i].name, &st) != 0) {
+            fprintf(stderr, "Error: Cannot stat file %s\n", streams[i].name);
+            rc = 1;
+            break;
+        }
+        if (st.st_size % record_size != 0) {
+            fprintf(stderr, "Error: %s is not a whole number of %zu-byte records\n",
+                    streams[i].name, record_size);
+            rc = 1;
+            break;
+        }
+        streams[i].fp = fopen(streams[i].name, "rb");
+        if (!streams[i].fp) {
+            fprintf(stderr, "Error: Cannot open %s\n", streams[i].name);
+            rc = 1;
+            break;
+        }
+        printf("  %s %s: %ld records\n", i == 0 ? "Base: " : "Delta:", streams[i].name,
+               (long)(st.st_size / record_size));
+        if (advance(&streams[i]) != 0) rc = 1;
+    }
+
+    FILE *out = NULL;
+    if (rc == 0) {
+        out = fopen(output_file, "wb");
+        if (!out) {
+            fprintf(stderr, "Error: Cannot open output file %s\n", output_file);
+            rc = 1;
+        }
+    }
+
+    // Each step writes the smallest head, taken from the latest file that has it,
+    // and moves every file holding that information set past it
+    long written = 0, superseded = 0;
+    while (rc == 0) {
+        int min = -1;
+        for (int i = 0; i < n; i++) {
+            if (streams[i].done) continue;
+            if (min < 0 || compare_heads(&streams[i], &streams[min]) <= 0) min = i;
+        }
+        if (min < 0) break;
+
+        if (fwrite(&streams[min].cur, record_size, 1, out) != 1) {
+            fprintf(stderr, "Error: Write failed on output file %s\n", output_file);
+            rc = 1;
+            break;
+        }
+        written++;
+
+        Stream head = streams[min];
+        for (int i = 0; i < n && rc == 0; i++) {
+            if (streams[i].done || compare_heads(&streams[i], &head) != 0) continue;
+            if (i != min) superseded++;
+            if (advance(&streams[i]) != 0) rc = 1;
+        }
+    }
+
+    for (int i = 0; i < n; i++)
+        if (streams[i].fp) fclose(streams[i].fp);
+    free(streams);
+    if (out && fclose(out) != 0) {
+        fprintf(stderr, "Error: Write failed on output file %s\n", output_file);
+        rc = 1;
+    }
+    if (rc != 0) {
+        fprintf(stderr, "Error: Compaction failed\n");
+        return 1;
+    }
+
+    printf("Wrote %ld records (%ld older versions dropped)\n", written, superseded);
+    return 0;
+}
@@ -0,0 +1,152 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "types.h"
+#include "game.h"
+#include "key.h"
+
+// Strat_255 as written before the legal action mask (27 bytes, actions in hand order)
+typedef struct {
+    UC bits[KEY_BYTES];
+    UC action_count;
+    UC action[MAX_ACTIONS];
+    UC s255[MAX_ACTIONS];
+} LegacyStrat_255;
+
+// Records sharing one key (one per legal action set, so at most a handful)
+#define MAX_RUN 64
+
+// Current record from a legacy one: actions in bit order, mask set
+static void convert_record(const LegacyStrat_255 *in, Strat_255 *out)
+{
+    UC order[MAX_ACTIONS];
+    memset(out, 0, sizeof(Strat_255));
+    memcpy(out->bits, in->bits, KEY_BYTES);
+    out->action_count = in->action_count;
+    action_order(in->action, in->action_count, order);
+    for (int j = 0; j < in->action_count; j++) {
+        out->action[j] = in->action[order[j]];
+        out->s255[j] = in->s255[order[j]];
+    }
+    out->mask = action_mask(out->action, out->action_count);
+}
+
+// Order one key's records by mask and average records that now share a mask
+// (older builds kept one record per action order); returns the records written
+static long flush_run(Strat_255 *run, int n, FILE *fp, long *merged)
+{
+    for (int i = 1; i < n; i++) {
+        Strat_255 r = run[i];
+        int j = i;
+        while (j > 0 && run[j - 1].mask > r.mask) {
+            run[j] = run[j - 1];
+            j--;
+        }
+        run[j] = r;
+    }
+
+    long written = 0;
+    for (int i = 0; i < n; ) {
+        int j = i + 1;
+        while (j < n && run[j].mask == run[i].mask) j++;
+        Strat_255 out = run[i];
+        if (j - i > 1) {
+            for (int a = 0; a < out.action_count; a++) {
+                int sum = 0;
+                for (int d = i; d < j; d++) sum += run[d].s255[a];
+                out.s255[a] = (UC)((sum + (j - i) / 2) / (j - i));
+            }
+            *merged += j - i - 1;
+        }
+        if (fwrite(&out, sizeof(Strat_255), 1, fp) != 1) return -1;
+        written++;
+        i = j;
+    }
+    return written;
+}
+
+// Convert a Strat_255 file from before the legal action mask to the current layout
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <legacy_strategy_file> <output_file>\n", argv[0]);
+        fprintf(stderr, "  Converts a %zu-byte Strat_255 file (no action mask) to the current %zu-byte layout\n",
+                sizeof(LegacyStrat_255), sizeof(Strat_255));
+        return 1;
+    }
+
+    struct stat st;
+    if (stat(argv[1], &st) != 0) {
+        fprintf(stderr, "Error: Cannot stat file %s\n", argv[1]);
+        return 1;
+    }
+    if (st.st_size % sizeof(LegacyStrat_255) != 0) {
+        fprintf(stderr, "Error: %s is not a whole number of %zu-byte legacy records\n",
+                argv[1], sizeof(LegacyStrat_255));
+        return 1;
+    }
+
+    FILE *in = fopen(argv[1], "rb");
+    if (!in) {
+        fprintf(stderr, "Error: Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    FILE *out = fopen(argv[2], "wb");
+    if (!out) {
+        fprintf(stderr, "Error: Cannot open output file %s\n", argv[2]);
+        fclose(in);
+        return 1;
+    }
+
+    printf("=== CT-CONV Strategy Converter ===\n");
+    printf("Input:  %s (%ld records)\n", argv[1], (long)(st.st_size / sizeof(LegacyStrat_255)));
+
+    // Legacy files are sorted by key, so each key's records are adjacent
+    Strat_255 run[MAX_RUN];
+    Key run_key = {0};
+    int n = 0;
+    long read = 0, written = 0, merged = 0;
+    int rc = 0;
+    LegacyStrat_255 rec;
+    while (fread(&rec, sizeof(rec), 1, in) == 1) {
+        read++;
+        if (rec.action_count == 0 || rec.action_count > MAX_ACTIONS) {
+            fprintf(stderr, "Error: Invalid action count %d at record %ld\n", rec.action_count, read);
+            rc = 1;
+            break;
+        }
+        Key k = key_from_bits(rec.bits);
+        if (n > 0 && (!key_equal(&k, &run_key) || n == MAX_RUN)) {
+            if (n == MAX_RUN || key_cmp(&k, &run_key) < 0) {
+                fprintf(stderr, "Error: %s is not sorted by key (record %ld); run ct-kwayp first\n",
+                        argv[1], read);
+                rc = 1;
+                break;
+            }
+            long w = flush_run(run, n, out, &merged);
+            if (w < 0) { rc = 1; break; }
+            written += w;
+            n = 0;
+        }
+        run_key = k;
+        convert_record(&rec, &run[n++]);
+    }
+    if (rc == 0 && n > 0) {
+        long w = flush_run(run, n, out, &merged);
+        if (w < 0) rc = 1;
+        else written += w;
+    }
+
+    fclose(in);
+    if (fclose(out) != 0) rc = 1;
+    if (rc != 0) {
+        fprintf(stderr, "Error: Conversion of %s failed\n", argv[1]);
+        return 1;
+    }
+
+    printf("Output: %s (%ld records, %ld duplicate action orders averaged)\n", argv[2], written, merged);
+    return 0;
+}
@@ -0,0 +1,229 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "types.h"
+#include "key.h"
+
+// Default bucket count: one ct slice (NODE_QTY in ct/cfr.h)
+#define DEFAULT_BUCKETS 10000000
+// Passes over the key set when timing each hash
+#define TIMING_PASSES 20
+
+typedef unsigned int (*HashFn)(const Key *k);
+
+// FNV-1a as ct's hash_key was before the word-wise key: bytes are read through a (signed) char pointer
+static unsigned int hash_fnv1a_ct(const Key *k)
+{
+    const char *ptr = (const char *)k;
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < KEY_BYTES; i++) {
+        h ^= ptr[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// FNV-1a over unsigned bytes (the reference definition)
+static unsigned int hash_fnv1a(const Key *k)
+{
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < KEY_BYTES; i++) {
+        h ^= k->bits[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Key as two little-endian words: bytes 0-7 and 8-13
+static inline void key_words(const Key *k, uint64_t *w0, uint64_t *w1)
+{
+    *w0 = 0;
+    *w1 = 0;
+    memcpy(w0, k->bits, 8);
+    memcpy(w1, k->bits + 8, KEY_BYTES - 8);
+}
+
+// Murmur3 64-bit finalizer over the two words
+static unsigned int hash_murmur_mix(const Key *k)
+{
+    uint64_t w0, w1;
+    key_words(k, &w0, &w1);
+    uint64_t h = w0 ^ (w1 * 0x9e3779b97f4a7c15ULL);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return (unsigned int)h;
+}
+
+// Multiply-fold: 64x64->128 product of the two (salted) words, high ^ low
+static unsigned int hash_mul_fold(const Key *k)
+{
+    uint64_t w0, w1;
+    key_words(k, &w0, &w1);
+    __uint128_t m = (__uint128_t)(w0 ^ 0xa0761d6478bd642fULL) * (w1 ^ 0xe7037ed1a0b428dbULL);
+    uint64_t h = (uint64_t)m ^ (uint64_t)(m >> 64);
+    return (unsigned int)(h ^ (h >> 32));
+}
+
+// ct's key_hash (key.h): mul-fold on the in-memory words
+static unsigned int hash_ct(const Key *k)
+{
+    return key_hash(k);
+}
+
+// CRC32C (Castagnoli), bitwise table; what a hardware crc32 instruction computes
+static uint32_t crc_table[256];
+
+static void crc_init(void)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int j = 0; j < 8; j++)
+            c = (c & 1) ? (c >> 1) ^ 0x82f63b78u : c >> 1;
+        crc_table[i] = c;
+    }
+}
+
+static unsigned int hash_crc32c(const Key *k)
+{
+    uint32_t c = 0xffffffffu;
+    for (size_t i = 0; i < KEY_BYTES; i++)
+        c = crc_table[(c ^ k->bits[i]) & 0xff] ^ (c >> 8);
+    return ~c;
+}
+
+static const struct {
+    const char *name;
+    HashFn fn;
+} hashes[] = {
+    { "fnv1a (old)", hash_fnv1a_ct },
+    { "fnv1a",       hash_fnv1a },
+    { "murmur-mix",  hash_murmur_mix },
+    { "mul-fold",    hash_mul_fold },
+    { "key_hash",    hash_ct },
+    { "crc32c",      hash_crc32c },
+};
+
+static int compare_key_bits(const void *a, const void *b)
+{
+    return key_cmp(a, b);
+}
+
+// Load the distinct keys of a Strat (S) or Strat_255 (Q) file
+static Key *load_keys(const char *filename, int quantized, long *count)
+{
+    struct stat st;
+    if (stat(filename, &st) != 0) {
+        fprintf(stderr, "Error: Cannot stat file %s\n", filename);
+        return NULL;
+    }
+    size_t record_size = quantized ? sizeof(Strat_255) : sizeof(Strat);
+    long n = st.st_size / (long)record_size;
+
+    FILE *fp = fopen(filename, "rb");
+    Key *keys = malloc((n ? n : 1) * sizeof(Key));
+    if (!fp || !keys) {
+        fprintf(stderr, "Error: Cannot read %s\n", filename);
+        if (fp) fclose(fp);
+        free(keys);
+        return NULL;
+    }
+
+    // Both record types start with the key bits
+    unsigned char rec[sizeof(Strat)];
+    long got = 0;
+    while (got < n && fread(rec, record_size, 1, fp) == 1)
+        keys[got++] = key_from_bits(rec);
+    fclose(fp);
+
+    qsort(keys, got, sizeof(Key), compare_key_bits);
+    long distinct = 0;
+    for (long i = 0; i < got; i++) {
+        if (distinct == 0 || !key_equal(&keys[distinct - 1], &keys[i]))
+            keys[distinct++] = keys[i];
+    }
+    *count = distinct;
+    return keys;
+}
+
+// Compare hash functions on real keys: speed and bucket spread
+int main(int argc, char *argv[])
+{
+    if (argc < 3 || argc > 4) {
+        fprintf(stderr, "Usage: %s <strategy_file> <format: S|Q> [buckets]\n", argv[0]);
+        fprintf(stderr, "  S = Strat (float, training output)  Q = Strat_255 (quantized, kwayp output)\n");
+        fprintf(stderr, "  buckets: table size to test (default %d, one ct slice)\n", DEFAULT_BUCKETS);
+        return 1;
+    }
+
+    char fmt = argv[2][0];
+    if (fmt != 'S' && fmt != 's' && fmt != 'Q' && fmt != 'q') {
+        fprintf(stderr, "Error: Invalid format '%c'. Use S (Strat) or Q (Strat_255).\n", fmt);
+        return 1;
+    }
+    long buckets = (argc == 4) ? atol(argv[3]) : DEFAULT_BUCKETS;
+    if (buckets <= 0) {
+        fprintf(stderr, "Error: Invalid bucket count %s\n", argv[3]);
+        return 1;
+    }
+
+    long n;
+    Key *keys = load_keys(argv[1], (fmt == 'Q' || fmt == 'q'), &n);
+    if (!keys) return 1;
+    crc_init();
+
+    double load = (double)n / buckets;
+    printf("=== CT-HASHB Hash Function Benchmark ===\n");
+    printf("Keys:    %ld distinct from %s\n", n, argv[1]);
+    printf("Buckets: %ld (load %.3f)\n", buckets, load);
+    printf("Ideal:   %.2f%% empty, avg chain %.4f for a uniform hash\n\n", 100.0 * exp(-load),
+           load / (1.0 - exp(-load)));
+    printf("%-12s %8s %9s %10s %6s %12s\n", "hash", "ns/key", "empty%", "avg chain", "max", "colliding");
+
+    unsigned int *len = malloc(buckets * sizeof(unsigned int));
+    if (!len) {
+        fprintf(stderr, "Error: Cannot allocate %ld buckets\n", buckets);
+        return 1;
+    }
+
+    for (size_t h = 0; h < sizeof(hashes) / sizeof(hashes[0]); h++) {
+        // Time: sum the hashes and hand the sum to an empty asm so the calls
+        // cannot be optimized away
+        struct timespec t0, t1;
+        unsigned int sum = 0;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (int pass = 0; pass < TIMING_PASSES; pass++)
+            for (long i = 0; i < n; i++)
+                sum += hashes[h].fn(&keys[i]);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        __asm__ volatile("" : : "r"(sum));
+        double ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) /
+                    ((double)n * TIMING_PASSES);
+
+        // Spread: bucket index as ct computes it, hash % buckets
+        memset(len, 0, buckets * sizeof(unsigned int));
+        for (long i = 0; i < n; i++)
+            len[hashes[h].fn(&keys[i]) % buckets]++;
+        long used = 0, max = 0, colliding = 0;
+        for (long b = 0; b < buckets; b++) {
+            if (len[b] == 0) continue;
+            used++;
+            if (len[b] > max) max = len[b];
+            colliding += len[b] - 1;
+        }
+
+        printf("%-12s %8.2f %8.2f%% %10.4f %6ld %12ld\n", hashes[h].name, ns,
+               100.0 * (buckets - used) / buckets, used ? (double)n / used : 0.0, max, colliding);
+    }
+
+    free(len);
+    free(keys);
+    return 0;
+}
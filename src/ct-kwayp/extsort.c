@@ -0,0 +1,214 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include <unistd.h>
+#include "extsort.h"
+#include "rsort.h"
+#include "strategy.h"
+#include "ltree.h"
+
+// stdio buffer per run (and for the output) while merging runs
+#define MIN_MERGE_BUFFER 4096
+#define MAX_MERGE_BUFFER (1L << 20)
+
+typedef struct {
+    FILE *fp;
+    Strat current;
+    SortPair key;    // current's sort key
+    bool exhausted;
+} Run;
+
+static void advance_run(Run *r)
+{
+    if (fread(&r->current, sizeof(Strat), 1, r->fp) != 1)
+        r->exhausted = true;
+    else
+        r->key = sort_pair(&r->current, 0);
+}
+
+// Read up to len records; every record gets its actions in bit order and a mask
+static long read_records(FILE *fp, Strat *buf, long len, bool *changed)
+{
+    long n = (long)fread(buf, sizeof(Strat), len, fp);
+    for (long i = 0; i < n; i++)
+        *changed |= order_strat(&buf[i]);
+    return n;
+}
+
+// Run order for the loser tree: sort key, ties to the earlier run (stable);
+// exhausted runs sort last
+static bool run_less(const void *ctx, int a, int b)
+{
+    const Run *rs = (const Run *)ctx;
+    if (rs[a].exhausted != rs[b].exhausted) return rs[b].exhausted;
+    if (rs[a].exhausted) return a < b;
+    int cmp = sort_pair_cmp(&rs[a].key, &rs[b].key);
+    if (cmp != 0) return cmp < 0;
+    return a < b;
+}
+
+// Merge the sorted runs into filename through a loser tree; ties go to the
+// earlier run (stable)
+static int merge_runs(char **names, int runs, const char *filename, long budget, long count)
+{
+    long bufsize = budget / (runs + 1);
+    if (bufsize < MIN_MERGE_BUFFER) bufsize = MIN_MERGE_BUFFER;
+    if (bufsize > MAX_MERGE_BUFFER) bufsize = MAX_MERGE_BUFFER;
+
+    Run *rs = calloc(runs, sizeof(Run));
+    if (!rs) {
+        fprintf(stderr, "Error: Cannot allocate %d runs\n", runs);
+        return -1;
+    }
+    int rc = 0;
+    for (int i = 0; i < runs && rc == 0; i++) {
+        rs[i].fp = fopen(names[i], "rb");
+        if (!rs[i].fp) {
+            fprintf(stderr, "Error: Cannot open run %s\n", names[i]);
+            rc = -1;
+            break;
+        }
+        setvbuf(rs[i].fp, NULL, _IOFBF, bufsize);
+        advance_run(&rs[i]);
+    }
+
+    FILE *out = NULL;
+    if (rc == 0) {
+        out = fopen(filename, "wb");
+        if (!out) {
+            fprintf(stderr, "Error: Cannot open %s for writing\n", filename);
+            rc = -1;
+        } else {
+            setvbuf(out, NULL, _IOFBF, bufsize);
+        }
+    }
+
+    LoserTree tree = { 0 };
+    if (rc == 0 && loser_tree_init(&tree, runs, run_less, rs) != 0) {
+        fprintf(stderr, "Error: Cannot allocate a merge tree for %d runs\n", runs);
+        rc = -1;
+    }
+    long written = 0;
+    while (rc == 0) {
+        int min = loser_tree_winner(&tree);
+        if (rs[min].exhausted) break;
+        if (fwrite(&rs[min].current, sizeof(Strat), 1, out) != 1) {
+            rc = -1;
+            break;
+        }
+        written++;
+        advance_run(&rs[min]);
+        loser_tree_replay(&tree);
+    }
+    loser_tree_free(&tree);
+    if (out && fclose(out) != 0) rc = -1;
+    if (out && (rc != 0 || written != count)) {
+        fprintf(stderr, "Error: Wrote %ld of %ld nodes to %s\n", written, count, filename);
+        rc = -1;
+    }
+
+    for (int i = 0; i < runs; i++)
+        if (rs[i].fp) fclose(rs[i].fp);
+    free(rs);
+    return rc;
+}
+
+int external_sort_file(const char *filename, long count, int threads, long budget)
+{
+    long run_len = (budget - sort_fixed_bytes(threads)) / SORT_RECORD_BYTES;
+    if (run_len < EXT_MIN_RUN) {
+        fprintf(stderr, "Error: Memory budget too small to sort %s (need at least %ld MB)\n", filename,
+                (sort_fixed_bytes(threads) + EXT_MIN_RUN * SORT_RECORD_BYTES + (1L << 20) - 1) >> 20);
+        return -1;
+    }
+    if (run_len > count) run_len = count;
+    if (run_len > (long)UINT32_MAX) run_len = UINT32_MAX;
+
+    FILE *in = fopen(filename, "rb");
+    Strat *buf = malloc(run_len * sizeof(Strat));
+    if (!in || !buf) {
+        fprintf(stderr, "Error: Cannot %s %s\n", in ? "allocate a run buffer for" : "open", filename);
+        if (in) fclose(in);
+        free(buf);
+        return -1;
+    }
+
+    // Files from ct --sorted are already in order: skip the sort and the rewrite
+    bool changed = false, sorted = true;
+    Strat prev;
+    long seen = 0;
+    while (seen < count) {
+        long n = read_records(in, buf, run_len, &changed);
+        if (n <= 0) break;
+        for (long i = 0; i < n && sorted; i++) {
+            if (seen + i > 0 && compare_keys(&prev, &buf[i]) > 0) sorted = false;
+            prev = buf[i];
+        }
+        seen += n;
+        if (!sorted) break;
+    }
+    if (sorted && seen == count && !changed) {
+        fclose(in);
+        free(buf);
+        printf("  %s: %ld nodes already sorted\n", filename, count);
+        return 0;
+    }
+    rewind(in);
+
+    // Sorted runs of run_len records
+    int runs = (int)((count + run_len - 1) / run_len);
+    char **names = calloc(runs, sizeof(char *));
+    int rc = names ? 0 : -1;
+    long total = 0;
+    for (int r = 0; r < runs && rc == 0; r++) {
+        names[r] = malloc(strlen(filename) + 32);
+        if (!names[r]) {
+            rc = -1;
+            break;
+        }
+        sprintf(names[r], "%s.run%d", filename, r);
+
+        long n = read_records(in, buf, run_len, &changed);
+        if (n <= 0) {
+            fprintf(stderr, "Error: Read %ld of %ld nodes from %s\n", total, count, filename);
+            rc = -1;
+            break;
+        }
+        total += n;
+        SortPair *pairs = radix_sort_pairs(buf, n, threads);
+        FILE *out = fopen(names[r], "wb");
+        long written = (pairs && out) ? write_pair_order(out, buf, pairs, n) : -1;
+        if (out && fclose(out) != 0) written = -1;
+        free(pairs);
+        if (written != n) {
+            fprintf(stderr, "Error: Cannot write run %s\n", names[r]);
+            rc = -1;
+        }
+    }
+    fclose(in);
+    free(buf);
+
+    // Merge into filename.tmp and rename it over the input only once it is complete,
+    // so a failed merge leaves the input as it was
+    char *tmp_name = malloc(strlen(filename) + 8);
+    if (rc == 0 && !tmp_name) rc = -1;
+    if (rc == 0) {
+        sprintf(tmp_name, "%s.tmp", filename);
+        rc = merge_runs(names, runs, tmp_name, budget, count);
+        if (rc == 0 && rename(tmp_name, filename) != 0) {
+            fprintf(stderr, "Error: Cannot rename %s to %s\n", tmp_name, filename);
+            rc = -1;
+        }
+        if (rc != 0) unlink(tmp_name);
+    }
+    free(tmp_name);
+
+    for (int r = 0; names && r < runs; r++) {
+        if (names[r]) unlink(names[r]);
+        free(names[r]);
+    }
+    free(names);
+    if (rc != 0) return -1;
+
+    printf("  %s: sorted %ld nodes externally (%d runs of up to %ld)\n", filename, count, runs, run_len);
+    return 0;
+}
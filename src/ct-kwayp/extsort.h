@@ -0,0 +1,20 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#ifndef EXTSORT_H
+#define EXTSORT_H
+
+#include "types.h"
+
+// External merge sort of one Strat file within a memory budget (-m)
+// - Used when sorting the file in memory would exceed budget bytes
+// - A streaming pass first checks whether the file is already in order
+// - Otherwise runs of as many records as the budget allows are radix sorted and
+//   written to <filename>.run<N>, then merged into <filename>.tmp, which replaces
+//   filename only when the merge succeeds; the runs are removed either way
+// - Stable like the in-memory sort, so the result is byte-identical to it
+// - Returns 0 on success, -1 on error (the budget is too small for one run of
+//   EXT_MIN_RUN records, or an I/O error)
+#define EXT_MIN_RUN 4096
+int external_sort_file(const char *filename, long count, int threads, long budget);
+
+#endif // EXTSORT_H
@@ -0,0 +1,47 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include "ltree.h"
+
+int loser_tree_init(LoserTree *t, int n, LoserLess less, const void *ctx)
+{
+    t->n = n;
+    t->less = less;
+    t->ctx = ctx;
+    t->loser = malloc(n * sizeof(int));
+    int *winner = malloc(2 * n * sizeof(int));
+    if (!t->loser || !winner) {
+        free(t->loser);
+        free(winner);
+        t->loser = NULL;
+        return -1;
+    }
+    for (int i = 0; i < n; i++) winner[n + i] = i;
+    for (int i = n - 1; i >= 1; i--) {
+        int a = winner[2 * i], b = winner[2 * i + 1];
+        bool a_wins = less(ctx, a, b);
+        winner[i] = a_wins ? a : b;
+        t->loser[i] = a_wins ? b : a;
+    }
+    t->loser[0] = (n > 1) ? winner[1] : 0;
+    free(winner);
+    return 0;
+}
+
+void loser_tree_replay(LoserTree *t)
+{
+    int w = t->loser[0];
+    for (int node = (w + t->n) / 2; node >= 1; node /= 2) {
+        if (t->less(t->ctx, t->loser[node], w)) {
+            int tmp = t->loser[node];
+            t->loser[node] = w;
+            w = tmp;
+        }
+    }
+    t->loser[0] = w;
+}
+
+void loser_tree_free(LoserTree *t)
+{
+    free(t->loser);
+    t->loser = NULL;
+}
@@ -0,0 +1,36 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#ifndef LTREE_H
+#define LTREE_H
+
+#include "types.h"
+
+// Loser tree over n sorted inputs: O(log n) comparisons per record instead of n
+// - less(ctx, a, b) orders the current heads of inputs a and b; it must put
+//   exhausted inputs last and break ties by input index for a stable merge
+// - Leaves n..2n-1 are the inputs, nodes 1..n-1 hold the loser of their match
+//   and loser[0] the overall winner
+// - Used by the k-way merge (merge.c) and the external sort's run merge (extsort.c)
+typedef bool (*LoserLess)(const void *ctx, int a, int b);
+
+typedef struct {
+    int n;
+    int *loser;
+    LoserLess less;
+    const void *ctx;
+} LoserTree;
+
+// Returns 0, or -1 if the tree cannot be allocated
+int loser_tree_init(LoserTree *t, int n, LoserLess less, const void *ctx);
+
+// Replay the winner's path after its input advanced
+void loser_tree_replay(LoserTree *t);
+
+void loser_tree_free(LoserTree *t);
+
+static inline int loser_tree_winner(const LoserTree *t)
+{
+    return t->loser[0];
+}
+
+#endif // LTREE_H
@@ -4,27 +4,66 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 #include "types.h"
 #include "merge.h"
 
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [-j threads] [-m MB] [-d] <output_file> <min_visits> <input_file1> [input_file2] ...\n", prog);
+    fprintf(stderr, "  Merges multiple strategy files into one\n");
+    fprintf(stderr, "  -j threads: threads for sorting each input file and for the merge (default 1)\n");
+    fprintf(stderr, "  -m MB: memory for sorting one input file; larger files are sorted\n");
+    fprintf(stderr, "         externally in runs (default 0 = no limit, sort in memory)\n");
+    fprintf(stderr, "  -d: drop merged input and written output from the page cache\n");
+    fprintf(stderr, "  min_visits: currently unused (for future pruning by visit count)\n");
+}
+
 int main(int argc, char *argv[])
 {
-    if (argc < 4) {
-        fprintf(stderr, "Usage: %s <output_file> <min_visits> <input_file1> [input_file2] ...\n", argv[0]);
-        fprintf(stderr, "  Merges multiple strategy files into one\n");
-        fprintf(stderr, "  min_visits: currently unused (for future pruning by visit count)\n");
+    MergeConfig config;
+    config.threads = 1;
+    config.mem_budget = 0;
+    config.drop_cache = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "j:m:d")) != -1) {
+        switch (opt) {
+            case 'j': config.threads = atoi(optarg); break;
+            case 'm': config.mem_budget = atol(optarg) << 20; break;
+            case 'd': config.drop_cache = true; break;
+            default:  usage(argv[0]); return 1;
+        }
+    }
+    if (argc - optind < 3) {
+        usage(argv[0]);
         return 1;
     }
-    
-    MergeConfig config;
-    config.output_file = argv[1];
-    config.min_visits = atoi(argv[2]);
-    config.num_files = argc - 3;
-    config.input_files = &argv[3];
+    if (config.threads < 1) {
+        fprintf(stderr, "Error: -j needs at least 1 thread\n");
+        return 1;
+    }
+    if (config.mem_budget < 0) {
+        fprintf(stderr, "Error: -m must be 0 (no limit) or a size in MB\n");
+        return 1;
+    }
+
+    char **pos = &argv[optind];
+    config.output_file = pos[0];
+    config.min_visits = atoi(pos[1]);
+    config.num_files = argc - optind - 2;
+    config.input_files = &pos[2];
     
     printf("=== CT-KWAYP K-Way Merge ===\n");
     printf("Output file: %s\n", config.output_file);
     printf("Min visits: %d\n", config.min_visits);
+    printf("Threads: %d\n", config.threads);
+    if (config.mem_budget > 0)
+        printf("Sort memory: %ld MB\n", config.mem_budget >> 20);
+    else
+        printf("Sort memory: no limit\n");
+    if (config.drop_cache)
+        printf("Page cache: dropped after merge I/O\n");
     printf("Input files: %d\n", config.num_files);
     for (int i = 0; i < config.num_files; i++) {
         printf("  %d: %s\n", i + 1, config.input_files[i]);
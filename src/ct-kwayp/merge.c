@@ -1,32 +1,77 @@
 // Copyright (c) 2026 Dave Hugh. All rights reserved.
 // Licensed under the GPL v3.0 License. See README.md for details.
-#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
 #include "merge.h"
+#include "strategy.h"
+#include "key.h"
+#include "rsort.h"
+#include "extsort.h"
+#include "ltree.h"
+
+// Merge I/O: each stream reads ahead a block of records, output groups are
+// collected in one large buffer, so libc and the kernel see few large requests
+#define MERGE_MEMORY (256L << 20)       // Input blocks and output buffers together (no -m budget)
+#define MIN_INPUT_BLOCK (64L << 10)     // Input block bytes per stream, at least
+#define MAX_INPUT_BLOCK (1L << 20)      // and at most
+#define OUTPUT_BLOCK (4L << 20)         // Output buffer bytes per range, at most
+#define MIN_OUTPUT_BLOCK (64L << 10)    // and at least
 
 // One open stream per input file during k-way merge
 typedef struct {
-    FILE *fp;
-    Strat current;   // Current head record from this file
-    bool exhausted;  // No more records in this file
+    int fd;
+    const char *name;
+    Strat *block;          // Records read ahead from the file
+    long block_cap;        // Records block holds
+    long block_len;        // Records in block
+    long pos;              // Index of current in block
+    off_t start;           // File offsets of this stream's record range
+    off_t end;
+    off_t offset;          // File offset of the next block
+    bool drop_cache;       // Drop consumed blocks from the page cache
+    bool failed;           // Read error
+    const Strat *current;  // Current head record from this file
+    Key key;               // current's key as words, for the comparisons in the merge tree
+    bool exhausted;        // No more records in this file
 } Stream;
 
-// Compare two Strat records by key (for qsort and merge comparison)
-// - If key is equal, check action count and then actions
-// - Need to include to separate nodes with different actions
-static int compare_keys(const void *a, const void *b)
+// Output written a buffer of records at a time, from a fixed file offset on
+typedef struct {
+    int fd;
+    off_t offset;          // File offset of the next buffer
+    Strat_255 *buf;
+    long len;
+    long cap;
+    bool drop_cache;       // Write back and drop each flushed buffer from the page cache
+} Output;
+
+// Write buf to filename in the order of pairs (NULL = as is)
+static int write_sorted(const char *filename, const Strat *buf, const SortPair *pairs, long count)
 {
-    const Strat *sa = (const Strat *)a;
-    const Strat *sb = (const Strat *)b;
-    int _1st = memcmp(sa->bits, sb->bits, sizeof(Key));
-    if (_1st != 0) return _1st;
-    if (sa->action_count != sb->action_count)
-         return (int)sa->action_count - (int)sb->action_count;
-     return memcmp(sa->action, sb->action, sa->action_count);
+    FILE *fp = fopen(filename, "wb");
+    if (!fp) {
+        fprintf(stderr, "Error: Cannot open %s for writing\n", filename);
+        return -1;
+    }
+    long written = write_pair_order(fp, buf, pairs, count);
+    if (fclose(fp) != 0) written = -1;
+
+    if (written != count) {
+        fprintf(stderr, "Error: Wrote %ld of %ld nodes to %s\n", written, count, filename);
+        return -1;
+    }
+    return 0;
 }
 
 // Load one file into memory, sort it, write it back sorted.
 // Only one file is ever in memory at a time.
-static int sort_file(const char *filename)
+// - Radix sort of (key, index) pairs on `threads` threads (see rsort.h); the
+//   records are then written out in pair order
+// - Files that do not fit in budget bytes (0 = no limit) are sorted externally
+static int sort_file(const char *filename, int threads, long budget)
 {
     FILE *fp = fopen(filename, "rb");
     if (!fp) {
@@ -44,6 +89,10 @@ static int sort_file(const char *filename)
         printf("  %s: empty, skipping\n", filename);
         return 0;
     }
+    if (budget > 0 && count * SORT_RECORD_BYTES + sort_fixed_bytes(threads) > budget) {
+        fclose(fp);
+        return external_sort_file(filename, count, threads, budget);
+    }
 
     Strat *buf = malloc(count * sizeof(Strat));
     if (!buf) {
@@ -61,115 +110,212 @@ static int sort_file(const char *filename)
         return -1;
     }
 
-    qsort(buf, count, sizeof(Strat), compare_keys);
+    // Records from older builds get their actions in bit order and a mask
+    bool changed = false;
+    for (long j = 0; j < count; j++)
+        changed |= order_strat(&buf[j]);
 
-    fp = fopen(filename, "wb");
-    if (!fp) {
-        fprintf(stderr, "Error: Cannot open %s for writing\n", filename);
+    // Files from ct --sorted are already in order: skip the sort and the rewrite
+    long i = 1;
+    while (i < count && compare_keys(&buf[i - 1], &buf[i]) <= 0) i++;
+    if (i == count && !changed) {
         free(buf);
-        return -1;
+        printf("  %s: %ld nodes already sorted\n", filename, count);
+        return 0;
     }
 
-    size_t written = fwrite(buf, sizeof(Strat), count, fp);
-    fclose(fp);
-    free(buf);
-
-    if ((long)written != count) {
-        fprintf(stderr, "Error: Wrote %zu of %ld nodes to %s\n", written, count, filename);
-        return -1;
+    // Records with changed actions but already in order are rewritten as they are
+    SortPair *pairs = NULL;
+    if (i < count) {
+        if (count > (long)UINT32_MAX) {
+            fprintf(stderr, "Error: %s has more than %u nodes\n", filename, UINT32_MAX);
+            free(buf);
+            return -1;
+        }
+        pairs = radix_sort_pairs(buf, count, threads);
+        if (!pairs) {
+            fprintf(stderr, "Error: Cannot allocate sort keys for %ld nodes of %s\n", count, filename);
+            free(buf);
+            return -1;
+        }
     }
 
+    int rc = write_sorted(filename, buf, pairs, count);
+    free(pairs);
+    free(buf);
+    if (rc != 0) return -1;
+
     printf("  %s: sorted %ld nodes\n", filename, count);
     return 0;
 }
 
-// Read the next record into a stream's current slot; mark exhausted on EOF
+// Read the next block; returns false at end of file or on error
+static bool read_block(Stream *s)
+{
+    if (s->drop_cache && s->block_len > 0)
+        posix_fadvise(s->fd, s->offset - s->block_len * (off_t)sizeof(Strat),
+                      s->block_len * (off_t)sizeof(Strat), POSIX_FADV_DONTNEED);
+
+    size_t want = s->block_cap * sizeof(Strat), got = 0;
+    if ((off_t)want > s->end - s->offset) want = s->end - s->offset;
+    while (got < want) {
+        ssize_t r = pread(s->fd, (char *)s->block + got, want - got, s->offset + got);
+        if (r < 0) {
+            fprintf(stderr, "Error: Read failed on %s\n", s->name);
+            s->failed = true;
+            return false;
+        }
+        if (r == 0) break;
+        got += r;
+    }
+    s->block_len = got / sizeof(Strat);
+    s->offset += s->block_len * sizeof(Strat);
+    s->pos = 0;
+    return s->block_len > 0;
+}
+
+// Move a stream to its next record; mark exhausted on EOF
 static void advance_stream(Stream *s)
 {
     if (s->exhausted) return;
-    if (fread(&s->current, sizeof(Strat), 1, s->fp) != 1)
+    if (++s->pos >= s->block_len && !read_block(s)) {
         s->exhausted = true;
+        return;
+    }
+    s->current = &s->block[s->pos];
+    s->key = key_from_bits(s->current->bits);
 }
 
-// Return the index of the stream with the smallest key, or -1 if all exhausted
-static int find_min(Stream *streams, int n)
+// Open records [first, last) of filename as a stream
+static int open_stream(Stream *s, const char *filename, long first, long last,
+                       long block_bytes, bool drop_cache)
 {
-    int min = -1;
-    for (int i = 0; i < n; i++) {
-        if (streams[i].exhausted) continue;
-        if (min == -1 ||
-            memcmp(streams[i].current.bits, streams[min].current.bits, sizeof(Key)) < 0)
-            min = i;
+    memset(s, 0, sizeof(Stream));
+    s->name = filename;
+    s->drop_cache = drop_cache;
+    s->start = s->offset = first * (off_t)sizeof(Strat);
+    s->end = last * (off_t)sizeof(Strat);
+    s->block_cap = block_bytes / sizeof(Strat);
+    s->block = malloc(s->block_cap * sizeof(Strat));
+    s->fd = open(filename, O_RDONLY);
+    if (s->fd < 0 || !s->block) {
+        fprintf(stderr, "Error: Cannot open %s for merge\n", filename);
+        if (s->fd >= 0) close(s->fd);
+        free(s->block);
+        s->fd = -1;
+        return -1;
     }
-    return min;
+    posix_fadvise(s->fd, s->start, s->end - s->start, POSIX_FADV_SEQUENTIAL);
+    s->pos = -1;
+    advance_stream(s);
+    return 0;
 }
 
-// Quantize strategy to reduce memory load when reading into eval
-// - This is a lossy operation, but it allows us to read the merged file into eval without blowing up memory
-// - We can adjust the quantization level (e.g. 255) to balance precision vs memory usage
-// - We also need to copy the key and action data, since those are needed for eval and are not quantized
-void quantize_output(Strat *st, Strat_255 *st2, int action_count) {
-    memset(st2, 0, sizeof(Strat_255));
-    memcpy(st2->bits, st->bits, sizeof(Key));
-    st2->action_count = st->action_count;
-    memcpy(st2->action, st->action, action_count); 
-    for (int i = 0; i < action_count; i++) {
-        if (isnan(st->strategy[i]) || st->strategy[i] < 0.0f) {
-            st2->s255[i] = 0;
-        } else if (st->strategy[i] > 1.0f) {
-            st2->s255[i] = 255;
-        } else {
-            st2->s255[i] = (uint8_t)(st->strategy[i] * 255.0f + 0.5f); // Round to nearest
-        }
-    }       
+static void close_stream(Stream *s)
+{
+    if (s->fd < 0) return;
+    if (s->drop_cache) posix_fadvise(s->fd, s->start, s->end - s->start, POSIX_FADV_DONTNEED);
+    close(s->fd);
+    free(s->block);
+    s->fd = -1;
 }
 
-
-// Perform k-way merge of pre-sorted streams, averaging duplicate keys on the fly
-static int kway_merge(Stream *streams, int n, const char *output_file,
-                      long *input_count, long *output_count)
+static int output_flush(Output *o)
 {
-    FILE *ofp = fopen(output_file, "wb");
-    if (!ofp) {
-        fprintf(stderr, "Error: Cannot open output file %s\n", output_file);
-        return -1;
+    const char *p = (const char *)o->buf;
+    size_t left = o->len * sizeof(Strat_255);
+    off_t start = o->offset;
+    while (left > 0) {
+        ssize_t w = pwrite(o->fd, p, left, o->offset);
+        if (w < 0) return -1;
+        p += w;
+        left -= w;
+        o->offset += w;
     }
+    o->len = 0;
+    if (o->drop_cache) {
+        if (fdatasync(o->fd) != 0) return -1;
+        posix_fadvise(o->fd, start, o->offset - start, POSIX_FADV_DONTNEED);
+    }
+    return 0;
+}
+
+static int output_put(Output *o, const Strat_255 *r)
+{
+    o->buf[o->len++] = *r;
+    return (o->len == o->cap) ? output_flush(o) : 0;
+}
+
+// Stream order for the loser tree: (key, mask), ties to the lower stream index so
+// duplicate groups are averaged in file order; exhausted streams sort last
+static bool stream_less(const void *ctx, int a, int b)
+{
+    const Stream *streams = (const Stream *)ctx;
+    if (streams[a].exhausted != streams[b].exhausted) return streams[b].exhausted;
+    if (streams[a].exhausted) return a < b;
+    int cmp = key_cmp(&streams[a].key, &streams[b].key);
+    if (cmp != 0) return cmp < 0;
+    if (streams[a].current->mask != streams[b].current->mask)
+        return streams[a].current->mask < streams[b].current->mask;
+    return a < b;
+}
+
+// Average a completed group and add it to the output as Strat_255
+static int emit_group(Output *o, Strat *accum, const float *strat_sums, long dup_count)
+{
+    for (int j = 0; j < accum->action_count; j++)
+        accum->strategy[j] = strat_sums[j] / (float)dup_count;
+
+    // Quantize strategy before writing to reduce memory load when reading into eval
+    Strat_255 s255;
+    quantize_output(accum, &s255, accum->action_count);
+    return output_put(o, &s255);
+}
 
+// Perform k-way merge of pre-sorted streams, averaging duplicate keys on the fly
+// - The groups are written to fd from offset on
+static int kway_merge(Stream *streams, int n, int fd, off_t offset, const char *output_file,
+                      long out_block, bool drop_cache, long *input_count, long *output_count)
+{
+    Output out = { fd, offset, NULL, 0, out_block / sizeof(Strat_255), drop_cache };
     *input_count = 0;
     *output_count = 0;
 
+    LoserTree tree;
+    out.buf = malloc(out.cap * sizeof(Strat_255));
+    if (!out.buf || loser_tree_init(&tree, n, stream_less, streams) != 0) {
+        fprintf(stderr, "Error: Cannot allocate merge buffers for %d streams\n", n);
+        free(out.buf);
+        return -1;
+    }
+
     // Accumulator for the current key group
     Strat accum;
+    Key accum_key;
     float strat_sums[MAX_ACTIONS];
     long dup_count = 0;
+    int rc = 0;
 
     while (true) {
-        int idx = find_min(streams, n);
-        if (idx == -1) break;   // All streams exhausted
+        int idx = loser_tree_winner(&tree);
+        if (streams[idx].exhausted) break;   // All streams exhausted
 
-        Strat *s = &streams[idx].current;
+        const Strat *s = streams[idx].current;
         (*input_count)++;
 
-        if (dup_count == 0 || memcmp(s->bits, accum.bits, sizeof(Key)) != 0 ||
-            s->action_count != accum.action_count || 
-            memcmp(s->action,accum.action,accum.action_count) != 0) {
+        if (dup_count == 0 || !key_equal(&streams[idx].key, &accum_key) ||
+            s->mask != accum.mask) {
             // Write completed group (if any) before starting a new one
             if (dup_count > 0) {
-                for (int j = 0; j < accum.action_count; j++)
-                    accum.strategy[j] = strat_sums[j] / (float)dup_count;
-
-                // Quantize strategy before writing to reduce memory load when reading into eval
-                Strat_255 s255;
-                quantize_output(&accum, &s255, accum.action_count);
-                if (fwrite(&s255, sizeof(Strat_255), 1, ofp) != 1) {
-                    fprintf(stderr, "Error: Write failed on output file\n");
-                    fclose(ofp);
-                    return -1;
+                if (emit_group(&out, &accum, strat_sums, dup_count) != 0) {
+                    rc = -1;
+                    break;
                 }
                 (*output_count)++;
             }
             // Begin new group
             accum = *s;
+            accum_key = streams[idx].key;
             memset(strat_sums, 0, sizeof(strat_sums));
             for (int j = 0; j < accum.action_count; j++)
                 strat_sums[j] = s->strategy[j];
@@ -182,26 +328,47 @@ static int kway_merge(Stream *streams, int n, const char *output_file,
         }
 
         advance_stream(&streams[idx]);
+        loser_tree_replay(&tree);
     }
+    loser_tree_free(&tree);
 
     // Flush the final group
-    if (dup_count > 0) {
-        for (int j = 0; j < accum.action_count; j++)
-            accum.strategy[j] = strat_sums[j] / (float)dup_count;
+    if (rc == 0 && dup_count > 0) {
+        if (emit_group(&out, &accum, strat_sums, dup_count) != 0)
+            rc = -1;
+        else
+            (*output_count)++;
+    }
+    if (rc == 0 && output_flush(&out) != 0) rc = -1;
+    free(out.buf);
+    if (rc != 0) {
+        fprintf(stderr, "Error: Write failed on output file %s\n", output_file);
+        return -1;
+    }
 
-        // Quantize strategy before writing to reduce memory load when reading into eval
-        Strat_255 s255;
-        quantize_output(&accum, &s255, accum.action_count);
+    for (int i = 0; i < n; i++)
+        if (streams[i].failed) return -1;
+    return 0;
+}
 
-        if (fwrite(&s255, sizeof(Strat_255), 1, ofp) != 1) {
-            fprintf(stderr, "Error: Write failed on final node\n");
-            fclose(ofp);
-            return -1;
-        }
-        (*output_count)++;
-    }
+// Monotonic wall clock in seconds
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
 
-    fclose(ofp);
+// Check that a -m budget covers one merge range: the minimum input block for every
+// file plus the minimum output buffer
+static int check_merge_budget(MergeConfig *config)
+{
+    long min_part = MIN_OUTPUT_BLOCK + (long)config->num_files * MIN_INPUT_BLOCK;
+    if (config->mem_budget > 0 && config->mem_budget < min_part) {
+        fprintf(stderr, "Error: Memory budget too small to merge %d files (need at least %ld MB)\n",
+                config->num_files, (min_part + (1L << 20) - 1) >> 20);
+        return -1;
+    }
     return 0;
 }
 
@@ -210,43 +377,283 @@ int merge_strategies(MergeConfig *config, MergeStats *stats)
 {
     memset(stats, 0, sizeof(MergeStats));
     int n = config->num_files;
+    // Reject a budget the merge cannot meet before spending time on the sort
+    if (check_merge_budget(config) != 0) return -1;
 
     // Phase 1: sort each input file individually (one file in memory at a time)
-    printf("Phase 1: Sorting %d input file(s)...\n", n);
+    printf("Phase 1: Sorting %d input file(s) on %d thread(s)...\n", n, config->threads);
+    double t0 = now_seconds();
     for (int i = 0; i < n; i++) {
-        if (sort_file(config->input_files[i]) != 0)
+        if (sort_file(config->input_files[i], config->threads, config->mem_budget) != 0)
             return -1;
     }
+    printf("  Sorted in %.2f seconds\n", now_seconds() - t0);
 
     // Phase 2: open all sorted files and k-way merge into output
     printf("Phase 2: K-way merge...\n");
+    return merge_sorted_files(config, stats);
+}
+
+// One key range of the merge: records [first[i], last[i]) of every input
+typedef struct {
+    MergeConfig *config;
+    long *first;
+    long *last;
+    long block;            // Input block bytes per stream
+    long out_block;        // Output buffer bytes
+    int fd;                // Output file, shared by all ranges
+    off_t offset;          // Where this range's groups are written
+    long input_count;
+    long output_count;
+    int rc;
+} MergePart;
+
+static void *merge_part(void *arg)
+{
+    MergePart *part = (MergePart *)arg;
+    MergeConfig *config = part->config;
+    int n = config->num_files;
+    part->rc = -1;
 
     Stream *streams = malloc(n * sizeof(Stream));
     if (!streams) {
         fprintf(stderr, "Error: Cannot allocate stream array\n");
-        return -1;
+        return NULL;
+    }
+    for (int i = 0; i < n; i++) {
+        if (open_stream(&streams[i], config->input_files[i], part->first[i], part->last[i],
+                        part->block, config->drop_cache) != 0) {
+            for (int j = 0; j < i; j++) close_stream(&streams[j]);
+            free(streams);
+            return NULL;
+        }
     }
+    part->rc = kway_merge(streams, n, part->fd, part->offset, config->output_file, part->out_block,
+                          config->drop_cache, &part->input_count, &part->output_count);
+    for (int i = 0; i < n; i++)
+        close_stream(&streams[i]);
+    free(streams);
+    return NULL;
+}
+
+static int read_record(int fd, long index, Strat *r)
+{
+    return pread(fd, r, sizeof(Strat), index * (off_t)sizeof(Strat)) == sizeof(Strat) ? 0 : -1;
+}
 
+// Split the key space into parts ranges of about equal input
+// - SPLIT_SAMPLES records per part, spread evenly over all inputs by record
+//   index, are sorted, and every SPLIT_SAMPLES-th one becomes a splitter
+// - Each input is binary searched for the first record >= each splitter, so a
+//   (key, mask) group never straddles two ranges
+// - bounds[p * n + i] is where range p starts in input i
+#define SPLIT_SAMPLES 64
+static int split_ranges(MergeConfig *config, const long *counts, long total, int parts, long *bounds)
+{
+    int n = config->num_files;
+    int *fds = malloc(n * sizeof(int));
+    long samples = (long)parts * SPLIT_SAMPLES;
+    Strat *sample = malloc(samples * sizeof(Strat));
+    if (!fds || !sample) {
+        fprintf(stderr, "Error: Cannot allocate merge splitters\n");
+        free(fds);
+        free(sample);
+        return -1;
+    }
+    int rc = 0;
     for (int i = 0; i < n; i++) {
-        streams[i].fp = fopen(config->input_files[i], "rb");
-        if (!streams[i].fp) {
+        fds[i] = open(config->input_files[i], O_RDONLY);
+        if (fds[i] < 0) {
             fprintf(stderr, "Error: Cannot open %s for merge\n", config->input_files[i]);
-            for (int j = 0; j < i; j++) fclose(streams[j].fp);
-            free(streams);
+            for (int j = 0; j < i; j++) close(fds[j]);
+            free(fds);
+            free(sample);
             return -1;
         }
-        streams[i].exhausted = false;
-        advance_stream(&streams[i]);
     }
 
-    long input_count = 0, output_count = 0;
-    int rc = kway_merge(streams, n, config->output_file, &input_count, &output_count);
+    for (long k = 0; k < samples && rc == 0; k++) {
+        long index = (long)((k + 0.5) * total / samples);
+        int i = 0;
+        while (index >= counts[i]) index -= counts[i++];
+        rc = read_record(fds[i], index, &sample[k]);
+    }
+    if (rc == 0) qsort(sample, samples, sizeof(Strat), compare_keys);
 
     for (int i = 0; i < n; i++) {
-        if (streams[i].fp) fclose(streams[i].fp);
+        bounds[i] = 0;
+        bounds[(long)parts * n + i] = counts[i];
+    }
+    for (int p = 1; p < parts && rc == 0; p++) {
+        const Strat *splitter = &sample[(long)p * SPLIT_SAMPLES];
+        for (int i = 0; i < n && rc == 0; i++) {
+            long lo = bounds[(long)(p - 1) * n + i], hi = counts[i];
+            while (lo < hi) {
+                long mid = lo + (hi - lo) / 2;
+                Strat r;
+                if (read_record(fds[i], mid, &r) != 0) {
+                    rc = -1;
+                    break;
+                }
+                if (compare_keys(&r, splitter) < 0) lo = mid + 1;
+                else hi = mid;
+            }
+            bounds[(long)p * n + i] = lo;
+        }
+    }
+    if (rc != 0) fprintf(stderr, "Error: Read failed while splitting the merge\n");
+
+    for (int i = 0; i < n; i++) close(fds[i]);
+    free(fds);
+    free(sample);
+    return rc;
+}
+
+// Move len bytes of fd from offset from down to offset to (to < from), front to
+// back a buffer at a time, so the overlap is never read after it is written
+static int move_down(int fd, off_t from, off_t to, off_t len, char *buf, long bufsize)
+{
+    while (len > 0) {
+        size_t want = (len < bufsize) ? (size_t)len : (size_t)bufsize;
+        ssize_t r = pread(fd, buf, want, from);
+        if (r <= 0) return -1;
+        for (ssize_t done = 0; done < r; ) {
+            ssize_t w = pwrite(fd, buf + done, r - done, to + done);
+            if (w < 0) return -1;
+            done += w;
+        }
+        from += r;
+        to += r;
+        len -= r;
+    }
+    return 0;
+}
+
+// Phase 2 alone: k-way merge of input files that are already sorted
+// - With threads > 1 the key space is split into that many ranges (split_ranges),
+//   each merged on its own thread straight into the output. A range can write at
+//   most one group per input record, so it starts where the ranges before it would
+//   end without duplicates; the gaps duplicates leave are closed afterwards by
+//   moving the later ranges down. Ranges hold whole (key, mask) groups, so the
+//   output is byte-identical to a single-threaded merge
+int merge_sorted_files(MergeConfig *config, MergeStats *stats)
+{
+    memset(stats, 0, sizeof(MergeStats));
+    int n = config->num_files;
+    int parts = config->threads;
+
+    long *counts = malloc(n * sizeof(long));
+    if (!counts) {
+        fprintf(stderr, "Error: Cannot allocate stream array\n");
+        return -1;
+    }
+    long total = 0;
+    for (int i = 0; i < n; i++) {
+        struct stat st;
+        if (stat(config->input_files[i], &st) != 0) {
+            fprintf(stderr, "Error: Cannot stat file %s\n", config->input_files[i]);
+            free(counts);
+            return -1;
+        }
+        counts[i] = st.st_size / sizeof(Strat);
+        total += counts[i];
+    }
+    // Small merges are not worth the threads
+    if (total < (long)parts * SPLIT_SAMPLES * 16) parts = 1;
+
+    // Input blocks and output buffers share the -m budget (or MERGE_MEMORY); use
+    // fewer ranges if each cannot get its minimum blocks
+    long memory = (config->mem_budget > 0) ? config->mem_budget : MERGE_MEMORY;
+    long min_part = MIN_OUTPUT_BLOCK + (long)n * MIN_INPUT_BLOCK;
+    if (config->mem_budget > 0 && check_merge_budget(config) != 0) {
+        free(counts);
+        return -1;
+    }
+    if (parts > 1 && parts > memory / min_part) {
+        parts = (memory / min_part > 1) ? (int)(memory / min_part) : 1;
+        printf("  Memory budget allows %d merge range%s\n", parts, parts > 1 ? "s" : "");
+    }
+    long share = memory / parts;
+    long out_block = share / 4;
+    if (out_block > OUTPUT_BLOCK) out_block = OUTPUT_BLOCK;
+    if (out_block > share - (long)n * MIN_INPUT_BLOCK) out_block = share - (long)n * MIN_INPUT_BLOCK;
+    if (out_block < MIN_OUTPUT_BLOCK) out_block = MIN_OUTPUT_BLOCK;
+    // Only without -m can a range be short of its minimum (too many inputs for
+    // MERGE_MEMORY); the input blocks then shrink so the total still fits
+    long block = (share - out_block) / n;
+    if (block > MAX_INPUT_BLOCK) block = MAX_INPUT_BLOCK;
+    if (block < (long)sizeof(Strat)) block = sizeof(Strat);
+
+    long *bounds = malloc((long)(parts + 1) * n * sizeof(long));
+    MergePart *part = calloc(parts, sizeof(MergePart));
+    pthread_t *tids = malloc(parts * sizeof(pthread_t));
+    char *buf = malloc(out_block);
+    int rc = (bounds && part && tids && buf) ? 0 : -1;
+    if (rc != 0) fprintf(stderr, "Error: Cannot allocate %d merge ranges\n", parts);
+    int fd = open(config->output_file, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open output file %s\n", config->output_file);
+        rc = -1;
     }
-    free(streams);
 
+    if (rc == 0 && parts > 1) {
+        printf("  Splitting the merge into %d key ranges\n", parts);
+        rc = split_ranges(config, counts, total, parts, bounds);
+    } else if (rc == 0) {
+        for (int i = 0; i < n; i++) {
+            bounds[i] = 0;
+            bounds[n + i] = counts[i];
+        }
+    }
+
+    double t0 = now_seconds();
+    int started = 0;
+    off_t offset = 0;
+    for (int p = 0; p < parts && rc == 0; p++) {
+        part[p] = (MergePart){ config, &bounds[(long)p * n], &bounds[(long)(p + 1) * n], block, out_block, fd, offset, 0, 0, -1 };
+        for (int i = 0; i < n; i++)
+            offset += (part[p].last[i] - part[p].first[i]) * (off_t)sizeof(Strat_255);
+        if (parts == 1) {
+            merge_part(&part[p]);
+        } else if (pthread_create(&tids[p], NULL, merge_part, &part[p]) != 0) {
+            fprintf(stderr, "Error: Cannot start merge thread %d\n", p);
+            rc = -1;
+            break;
+        }
+        started++;
+    }
+    if (parts > 1)
+        for (int p = 0; p < started; p++)
+            pthread_join(tids[p], NULL);
+
+    long input_count = 0, output_count = 0;
+    for (int p = 0; p < started; p++) {
+        if (part[p].rc != 0) rc = -1;
+        input_count += part[p].input_count;
+        output_count += part[p].output_count;
+    }
+    // Close the gaps left by ranges that averaged duplicates
+    off_t end = 0;
+    for (int p = 0; p < started && rc == 0; p++) {
+        off_t len = part[p].output_count * (off_t)sizeof(Strat_255);
+        if (part[p].offset != end && move_down(fd, part[p].offset, end, len, buf, out_block) != 0) {
+            fprintf(stderr, "Error: Cannot move merge range %d in %s\n", p, config->output_file);
+            rc = -1;
+        }
+        end += len;
+    }
+    if (rc == 0 && ftruncate(fd, end) != 0) {
+        fprintf(stderr, "Error: Cannot truncate %s\n", config->output_file);
+        rc = -1;
+    }
+    if (fd >= 0 && close(fd) != 0) rc = -1;
+    if (rc == 0) printf("  Merged in %.2f seconds\n", now_seconds() - t0);
+
+    free(buf);
+    free(tids);
+    free(part);
+    free(bounds);
+    free(counts);
     if (rc != 0) return -1;
 
     stats->total_nodes_input  = input_count;
@@ -11,6 +11,9 @@ typedef struct {
     char **input_files;
     char *output_file;
     int min_visits;  // Minimum visits to keep a node
+    int threads;     // Sort threads per file, and key ranges merged in parallel
+    long mem_budget; // Bytes for sorting one file, 0 = no limit (larger files sort externally)
+    bool drop_cache; // Keep merge I/O out of the page cache (posix_fadvise DONTNEED)
 } MergeConfig;
 
 // Merge statistics
@@ -22,6 +25,7 @@ typedef struct {
 
 // Merge functions
 int merge_strategies(MergeConfig *config, MergeStats *stats);
+int merge_sorted_files(MergeConfig *config, MergeStats *stats);  // Phase 2 only; inputs must be sorted
 void print_merge_stats(MergeStats *stats);
 
 #endif // MERGE_H
@@ -0,0 +1,153 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include <pthread.h>
+#include "rsort.h"
+#include "key.h"
+
+// 16-bit digits: 8 passes over the 128-bit key. Each key byte takes only a few
+// dozen values, so a pass touches a few hundred of the 65536 buckets at most
+#define DIGIT_BITS 16
+#define RADIX (1 << DIGIT_BITS)
+#define DIGITS (128 / DIGIT_BITS)
+#define DIGITS_PER_WORD (64 / DIGIT_BITS)
+
+// Records gathered per fwrite by write_pair_order
+#define WRITE_CHUNK 65536
+
+typedef struct {
+    const Strat *recs;
+    SortPair *src;
+    SortPair *dst;
+    long lo, hi;            // This thread's chunk [lo, hi)
+    int digit;              // 0 = least significant digit of lo ... DIGITS - 1 = most significant of hi
+    long *count;            // RADIX entries: digit histogram of the chunk, then its scatter offsets
+} RadixJob;
+
+static inline unsigned digit_of(const SortPair *p, int d)
+{
+    uint64_t w = (d < DIGITS_PER_WORD) ? p->lo : p->hi;
+    return (unsigned)(w >> (DIGIT_BITS * (d % DIGITS_PER_WORD))) & (RADIX - 1);
+}
+
+static void *build_pairs(void *arg)
+{
+    RadixJob *job = (RadixJob *)arg;
+    for (long i = job->lo; i < job->hi; i++)
+        job->dst[i] = sort_pair(&job->recs[i], (uint32_t)i);
+    return NULL;
+}
+
+static void *count_digits(void *arg)
+{
+    RadixJob *job = (RadixJob *)arg;
+    memset(job->count, 0, RADIX * sizeof(long));
+    for (long i = job->lo; i < job->hi; i++)
+        job->count[digit_of(&job->src[i], job->digit)]++;
+    return NULL;
+}
+
+static void *scatter(void *arg)
+{
+    RadixJob *job = (RadixJob *)arg;
+    for (long i = job->lo; i < job->hi; i++)
+        job->dst[job->count[digit_of(&job->src[i], job->digit)]++] = job->src[i];
+    return NULL;
+}
+
+// Run fn on every job and wait for all of them
+static void run_jobs(RadixJob *jobs, pthread_t *tid, int threads, void *(*fn)(void *))
+{
+    if (threads == 1) {
+        fn(&jobs[0]);
+        return;
+    }
+    for (int t = 0; t < threads; t++)
+        pthread_create(&tid[t], NULL, fn, &jobs[t]);
+    for (int t = 0; t < threads; t++)
+        pthread_join(tid[t], NULL);
+}
+
+SortPair *radix_sort_pairs(const Strat *recs, long n, int threads)
+{
+    if (threads < 1) threads = 1;
+    if (threads > n) threads = (n > 0) ? (int)n : 1;
+
+    SortPair *a = malloc((n ? n : 1) * sizeof(SortPair));
+    SortPair *b = malloc((n ? n : 1) * sizeof(SortPair));
+    RadixJob *jobs = malloc(threads * sizeof(RadixJob));
+    pthread_t *tid = malloc(threads * sizeof(pthread_t));
+    long *counts = malloc((long)threads * RADIX * sizeof(long));
+    if (!a || !b || !jobs || !tid || !counts) {
+        free(a);
+        free(b);
+        free(jobs);
+        free(tid);
+        free(counts);
+        return NULL;
+    }
+
+    for (int t = 0; t < threads; t++) {
+        jobs[t].recs = recs;
+        jobs[t].src = a;
+        jobs[t].dst = a;
+        jobs[t].lo = n * t / threads;
+        jobs[t].hi = n * (t + 1) / threads;
+        jobs[t].count = counts + (long)t * RADIX;
+    }
+    run_jobs(jobs, tid, threads, build_pairs);
+
+    for (int d = 0; d < DIGITS; d++) {
+        for (int t = 0; t < threads; t++) {
+            jobs[t].src = a;
+            jobs[t].dst = b;
+            jobs[t].digit = d;
+        }
+        run_jobs(jobs, tid, threads, count_digits);
+
+        // Offsets: digit-major, thread-minor, so each thread's records land in
+        // input order after those of earlier threads (stable)
+        long pos = 0;
+        bool trivial = false;
+        for (int r = 0; r < RADIX; r++) {
+            long digit_total = 0;
+            for (int t = 0; t < threads; t++) {
+                long c = jobs[t].count[r];
+                jobs[t].count[r] = pos;
+                pos += c;
+                digit_total += c;
+            }
+            if (digit_total == n) trivial = true;
+        }
+        if (trivial) continue;   // Every record has this digit: the pass is a copy
+
+        run_jobs(jobs, tid, threads, scatter);
+        SortPair *swap = a; a = b; b = swap;
+    }
+
+    free(b);
+    free(jobs);
+    free(tid);
+    free(counts);
+    return a;
+}
+
+long sort_fixed_bytes(int threads)
+{
+    return (long)threads * RADIX * (long)sizeof(long) + WRITE_CHUNK * (long)sizeof(Strat);
+}
+
+long write_pair_order(FILE *fp, const Strat *recs, const SortPair *pairs, long n)
+{
+    Strat *chunk = malloc(WRITE_CHUNK * sizeof(Strat));
+    if (!chunk) return -1;
+    long written = 0;
+    for (long i = 0; i < n; i += WRITE_CHUNK) {
+        long len = (n - i < WRITE_CHUNK) ? n - i : WRITE_CHUNK;
+        for (long k = 0; k < len; k++)
+            chunk[k] = recs[pairs ? pairs[i + k].idx : i + k];
+        written += (long)fwrite(chunk, sizeof(Strat), len, fp);
+        if (written != i + len) break;
+    }
+    free(chunk);
+    return written;
+}
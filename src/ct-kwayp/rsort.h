@@ -0,0 +1,48 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#ifndef RSORT_H
+#define RSORT_H
+
+#include "types.h"
+#include "key.h"
+
+// Sort key of one Strat record plus its position in the input
+// - hi/lo are the 16 bytes (14 key bytes, then the mask) as big-endian integers,
+//   so (hi, lo) order is compare_keys order
+typedef struct {
+    uint64_t hi;
+    uint64_t lo;
+    uint32_t idx;
+} SortPair;
+
+KEY_INLINE SortPair sort_pair(const Strat *r, uint32_t idx)
+{
+    Key k = key_from_bits(r->bits);
+    SortPair p = { KEY_ORDER_WORD(k.w[0]), KEY_ORDER_WORD(k.w[1]) | r->mask, idx };
+    return p;
+}
+
+KEY_INLINE int sort_pair_cmp(const SortPair *a, const SortPair *b)
+{
+    if (a->hi != b->hi) return a->hi < b->hi ? -1 : 1;
+    if (a->lo != b->lo) return a->lo < b->lo ? -1 : 1;
+    return 0;
+}
+
+// Memory for sorting n records in memory: the records, two pair arrays, and a
+// fixed part (per-thread digit counts and the write-back chunk)
+#define SORT_RECORD_BYTES ((long)(sizeof(Strat) + 2 * sizeof(SortPair)))
+long sort_fixed_bytes(int threads);
+
+// Parallel LSD radix sort of n records into (key, index) pairs
+// - 16-bit digits, least significant first; each pass counts and scatters on
+//   `threads` threads, and passes where every record has the same digit are skipped
+// - Stable, so equal records keep their input order
+// - Returns the sorted pairs (freed by the caller), or NULL if out of memory
+SortPair *radix_sort_pairs(const Strat *recs, long n, int threads);
+
+// Write recs in the order of pairs (NULL = as is) through a chunk buffer
+// - Returns the number of records written (n on success), or -1 if out of memory
+long write_pair_order(FILE *fp, const Strat *recs, const SortPair *pairs, long n);
+
+#endif // RSORT_H
@@ -6,6 +6,7 @@
 #include <sys/stat.h>
 #include "types.h"
 #include "util.h"
+#include "game.h"
 
 // Validate and print info about a strategy binary file
 int main(int argc, char *argv[])
@@ -65,6 +66,7 @@ int main(int argc, char *argv[])
     long total_nodes = 0;
     long action_counts[MAX_ACTIONS + 1] = {0};
     int do_print = (print_nodes == 'Y' || print_nodes == 'y');
+    long bad_masks = 0;  // Strat_255 records whose mask disagrees with their actions
 
     if (quantized) {
         Strat_255 s;
@@ -78,6 +80,11 @@ int main(int argc, char *argv[])
                 return 1;
             }
             action_counts[s.action_count]++;
+            if (s.mask != action_mask(s.action, s.action_count)) {
+                if (bad_masks++ == 0)
+                    fprintf(stderr, "Warning: Mask 0x%03x does not match the actions at node %ld "
+                            "(file from an older build? see ct-conv)\n", s.mask, total_nodes);
+            }
 
             float sum = 0.0f;
             for (int i = 0; i < s.action_count; i++)
@@ -131,6 +138,11 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (bad_masks > 0) {
+        printf("\nWARNING: %ld records have a legal action mask that does not match their actions\n", bad_masks);
+        return 1;
+    }
+
     printf("\n✅ File is valid!\n");
 
     return 0;
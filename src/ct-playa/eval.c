@@ -174,7 +174,7 @@ static int play_hand_selfplay_record(State *s, Strat_255 *strat, long strat_coun
         rec->dealer        = s->dealer;
         rec->winning_bidder = 0; // filled in retroactively
         rec->winning_bid    = 0; // filled in retroactively
-        memcpy(rec->key, k.bits, sizeof(k.bits));
+        memcpy(rec->key, k.bits, sizeof(rec->key));
         rec->action        = chosen_action;
         rec->strategy_hit  = strategy_hit;
 
@@ -268,7 +268,9 @@ static int play_hand_selfplay_bid_record(State *s, Strat_255 *strat, long strat_
             num_actions = legal_play(s, actions);
 
         Key k = build_key(s);
-        int sidx = find_node(strat, strat_count, &k);
+        uint16_t legal = action_mask(actions, num_actions);
+        int sidx = find_node_mask(strat, strat_count, &k, legal);
+        if (sidx < 0) sidx = find_node(strat, strat_count, &k);
         int strategy_hit = 0;
 
         if (sidx >= 0) {
@@ -277,13 +279,10 @@ static int play_hand_selfplay_bid_record(State *s, Strat_255 *strat, long strat_
             chosen_action = 0xff;
             for (int i = 0; i < strat[sidx].action_count; i++) {
                 UC a = strat[sidx].action[i];
-                for (int j = 0; j < num_actions; j++) {
-                    float prob = strat[sidx].s255[i] / 255.0f;
-                    if (actions[j] == a && prob > best_prob) {
-                        best_prob = prob;
-                        chosen_action = a;
-                        break;
-                    }
+                float prob = strat[sidx].s255[i] / 255.0f;
+                if ((action_bit(a) & legal) && prob > best_prob) {
+                    best_prob = prob;
+                    chosen_action = a;
                 }
             }
             if (chosen_action != 0xff)
@@ -341,14 +340,17 @@ void eval_games(Strat_255 *strat, long strat_count, int iterations, unsigned int
     init_eval_stats(stats);
     
     for (int i = 0; i < iterations; i++) {
+        Rng rng;
+        rng_init(&rng, seed, (uint64_t)i);
+
         State s = {0};
-        s.seed = seed + i;
-        s.dealer = get_random(0, 1, &s.seed);
+        s.seed = (unsigned int)rng_next(&rng);  // Random-player choices during the hand
+        s.dealer = rng_bounded(&rng, 2);
         s.stage = BID;
         s.to_act = 1 - s.dealer;
         s.trump = PRE_TRUMP;
         
-        make_cards_and_deal(&s);
+        deal_hands(&s, &rng);
         
         // Play hand
         if (mode == MODE_POLICY) {
@@ -393,14 +395,17 @@ void eval_games_selfplay(Strat_255 *strat, long strat_count, int iterations,
     uint32_t total_bid_records = 0;
 
     for (int i = 0; i < iterations; i++) {
+        Rng rng;
+        rng_init(&rng, seed, (uint64_t)i);
+
         State s = {0};
-        s.seed = seed + i;
-        s.dealer = get_random(0, 1, &s.seed);
+        s.seed = (unsigned int)rng_next(&rng);  // Random-player choices during the hand
+        s.dealer = rng_bounded(&rng, 2);
         s.stage = BID;
         s.to_act = 1 - s.dealer;
         s.trump = PRE_TRUMP;
 
-        make_cards_and_deal(&s);
+        deal_hands(&s, &rng);
 
         int ndecisions;
         if (dataset_mode == 0)
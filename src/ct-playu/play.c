@@ -2,6 +2,7 @@
 #include "bid.h"
 #include "play.h"
 #include "deck.h"
+#include "util.h"
 #include "hand.h"
 
 // Log a message with a timestamp to the log file
@@ -102,12 +103,13 @@ int play_game(Strat_255 *strat, long strat_cnt, UC winning_score, UC dealer, uns
         memset(s, 0x00, sizeof(State)); // Clear game state for new hand
         s->dealer = dealer;
         s->to_act = 1 - dealer; // First to act is non-dealer
-        s->seed = seed += 1000; // Update seed for next hand
         
         hand_num++;
-        // Make and deal cards
-        s->seed += hand_num * 1000; // Seed the random number generator seed
-        make_cards_and_deal(s);
+        // Make and deal cards from the hand's own stream of the game seed
+        Rng rng;
+        rng_init(&rng, seed, hand_num);
+        s->seed = (unsigned int)rng_next(&rng);
+        deal_hands(s, &rng);
 
         // Sort hands to make it easier for user to see in display
         qsort(s->hand[0].card, HAND_SIZE, sizeof(Card), compare_cards);
@@ -4,18 +4,169 @@
 #include "game.h"
 #include "abstraction.h"
 #include "deck.h"
+#include "pool.h"
+#include "prof.h"
+#include "key.h"
 #include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
-// FNV-1a 32-bit hash
-unsigned int hash_key(Key *k)
+// Lock stripes for shared-slice mode
+// - Bucket chains are guarded by the stripe of their bucket index, node sums by the
+//   stripe of the node address; a thread never holds both, so there is no lock order
+#define LOCK_STRIPES 4096
+static pthread_mutex_t stripes[LOCK_STRIPES];
+static bool shared_table = false;
+
+// Enable locking for tables whose slice is shared between threads
+void cfr_set_shared(bool shared)
+{
+    if (shared && !shared_table) {
+        for (int i = 0; i < LOCK_STRIPES; i++)
+            pthread_mutex_init(&stripes[i], NULL);
+    }
+    shared_table = shared;
+}
+
+// Live node and non-empty bucket counts, one cache line per slice
+// - A slice is written only by the thread training it, except in shared-slice mode
+//   where every thread creates nodes in slice 0; the monitor only reads
+typedef struct {
+    _Alignas(64) atomic_long nodes;
+    atomic_long buckets;
+} SliceCounts;
+
+static SliceCounts *slice_counts = NULL;
+
+void cfr_init_counts(int slices)
 {
-    char *ptr = (char *) k;
-    unsigned int h = 2166136261u;
-    for (size_t i = 0; i < sizeof(Key); i++) {
-        h ^= ptr[i];
-        h *= 16777619u;
+    slice_counts = aligned_alloc(_Alignof(SliceCounts), slices * sizeof(SliceCounts));
+    if (!slice_counts) return;
+    for (int i = 0; i < slices; i++) {
+        atomic_init(&slice_counts[i].nodes, 0);
+        atomic_init(&slice_counts[i].buckets, 0);
+    }
+}
+
+// Single writer: a relaxed load and store; shared slice: an atomic add
+static inline void slice_add(atomic_long *count, long n)
+{
+    if (shared_table)
+        atomic_fetch_add_explicit(count, n, memory_order_relaxed);
+    else
+        atomic_store_explicit(count, atomic_load_explicit(count, memory_order_relaxed) + n,
+                              memory_order_relaxed);
+}
+
+long cfr_slice_nodes(int slice)
+{
+    return slice_counts ? atomic_load_explicit(&slice_counts[slice].nodes, memory_order_relaxed) : 0;
+}
+
+long cfr_slice_buckets(int slice)
+{
+    return slice_counts ? atomic_load_explicit(&slice_counts[slice].buckets, memory_order_relaxed) : 0;
+}
+
+// Dirty lists, one per slice (cfr_track_dirty)
+// - Appended only on a node's first update since its dirty flag was cleared; in
+//   shared-slice mode every thread appends to slice 0's list under its lock
+typedef struct {
+    DirtyKey *keys;
+    long count;
+    long cap;
+    pthread_mutex_t lock;
+} DirtyList;
+
+static DirtyList *dirty_lists = NULL;
+static int dirty_slices = 0;
+
+void cfr_track_dirty(int slices)
+{
+    dirty_lists = calloc(slices, sizeof(DirtyList));
+    if (!dirty_lists) {
+        fprintf(stderr, "Error: Out of memory allocating %d dirty lists\n", slices);
+        exit(1);
+    }
+    for (int i = 0; i < slices; i++)
+        pthread_mutex_init(&dirty_lists[i].lock, NULL);
+    dirty_slices = slices;
+}
+
+long cfr_take_dirty(int slice, DirtyKey **keys)
+{
+    *keys = NULL;
+    if (!dirty_lists || slice >= dirty_slices) return 0;
+    DirtyList *list = &dirty_lists[slice];
+    long count = list->count;
+    *keys = list->keys;
+    list->keys = NULL;
+    list->count = list->cap = 0;
+    return count;
+}
+
+static void dirty_append(DirtyList *list, const Node *node)
+{
+    if (shared_table) pthread_mutex_lock(&list->lock);
+    if (list->count == list->cap) {
+        long cap = list->cap ? list->cap * 2 : 4096;
+        DirtyKey *keys = realloc(list->keys, cap * sizeof(DirtyKey));
+        if (!keys) {
+            fprintf(stderr, "Error: Out of memory growing a dirty list to %ld nodes\n", cap);
+            exit(1);
+        }
+        list->keys = keys;
+        list->cap = cap;
     }
-    return h;
+    list->keys[list->count++] = (DirtyKey){ node->key, node->mask };
+    if (shared_table) pthread_mutex_unlock(&list->lock);
+}
+
+// Called with the node locked (shared-slice mode), so the flag test is not racy
+static inline void mark_dirty(Node *node, int slice)
+{
+    if (node->dirty) return;
+    node->dirty = 1;
+    if (dirty_lists) dirty_append(&dirty_lists[slice], node);
+}
+
+void cfr_release_nodes(int slice, long nodes, long buckets)
+{
+    if (!slice_counts) return;
+    slice_add(&slice_counts[slice].nodes, -nodes);
+    slice_add(&slice_counts[slice].buckets, -buckets);
+}
+
+// Only the owning thread writes its counter, so a relaxed load and store is enough
+static _Thread_local atomic_long *visit_counter = NULL;
+
+void cfr_set_visit_counter(atomic_long *counter)
+{
+    visit_counter = counter;
+}
+
+static inline void count_visit(void)
+{
+    if (visit_counter)
+        atomic_store_explicit(visit_counter,
+                              atomic_load_explicit(visit_counter, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+}
+
+static inline void lock_node(Node *node)
+{
+    if (shared_table) pthread_mutex_lock(&stripes[((uintptr_t)node >> 6) % LOCK_STRIPES]);
+}
+
+static inline void unlock_node(Node *node)
+{
+    if (shared_table) pthread_mutex_unlock(&stripes[((uintptr_t)node >> 6) % LOCK_STRIPES]);
+}
+
+// 32-bit key hash (word-wise multiply-fold, see key.h)
+unsigned int hash_key(Key *k)
+{
+    return key_hash(k);
 }
 
 // Apply modulus operator to retrieved hash
@@ -26,62 +177,96 @@ unsigned int idx_hash(Key *k, int size)
 }
 // Get or create node in hash table
 // - Hash table with chaining (linked lists)
-// - Handles collisions where same key has different legal actions
-Node *get_or_create(Node **pa, Key *key, UC actions[], UC legal_n, int thread_num)
+// - Handles collisions where same key has different legal actions: a node matches
+//   on key and legal action mask
+Node *get_or_create(Node **pa, Key *key, UC actions[], UC legal_n, uint16_t mask, int thread_num)
 {
+    PROF_SCOPE(PROF_GET_OR_CREATE);
     long idx = idx_hash(key, NODE_QTY) + (NODE_QTY * thread_num);
+    if (shared_table) pthread_mutex_lock(&stripes[idx % LOCK_STRIPES]);
     Node *cur = pa[idx];
 
     // Loop through the bucket if a collision
     while (cur) {
-        if (memcmp(&cur->key, key, sizeof(Key)) == 0) {
-            // Key matches - check if actions also match
-            if (cur->action_count != legal_n) {
-                // Same key, different number of actions - keep searching
-                cur = cur->next;
-                continue;
-            }
-            
-            // Check if action arrays match (order may differ)
-            bool actions_match = true;
-            for (int i = 0; i < legal_n; i++) {
-                bool found = false;
-                for (int j = 0; j < cur->action_count; j++) {
-                    if (cur->action[j] == actions[i]) {
-                        found = true;
-                        break;
-                    }
-                }
-                if (!found) {
-                    actions_match = false;
-                    break;
-                }
-            }
-            
-            if (actions_match) {
-                return cur;  // Exact match found
-            } else {
-                // Same key, different actions - keep searching
-                cur = cur->next;
-                continue;
-            }
+        if (cur->mask == mask && PROF_KEY_EQUAL(&cur->key, key)) {
+            if (shared_table) pthread_mutex_unlock(&stripes[idx % LOCK_STRIPES]);
+            return cur;  // Exact match found
         }
         cur = cur->next;
     }
 
     // No exact match found - create new node
     Node *node = (Node *) calloc(1, sizeof(Node));
-    memcpy(&node->key, key, sizeof(Key));
+    if (!node) {
+        fprintf(stderr, "Error: Out of memory creating node (slice %d); see --max-mem\n", thread_num);
+        exit(1);
+    }
+    if (slice_counts) {
+        slice_add(&slice_counts[thread_num].nodes, 1);
+        if (!pa[idx]) slice_add(&slice_counts[thread_num].buckets, 1);
+    }
+    node->key = *key;
     node->action_count = legal_n;
+    node->mask = mask;
     memcpy(node->action, actions, legal_n * sizeof(UC));
     node->next = pa[idx];
     pa[idx] = node;
+    if (shared_table) pthread_mutex_unlock(&stripes[idx % LOCK_STRIPES]);
     
     return node;
 }
 
+#ifdef SAMPLED_AVG
+// Average strategy units credited per visit
+#define AVG_UNITS 16
+
+// Sampled average strategy
+// - Each visit spreads AVG_UNITS counts over the actions by systematic sampling: one
+//   uniform offset u, and action i gets floor(AVG_UNITS * C_i + u) - floor(AVG_UNITS * C_{i-1} + u)
+//   for cumulative strategy C. Counts have the same expectation as AVG_UNITS * strategy_sum
+//   but each action is off by less than one unit per visit
+// - u is seeded from (key, visits), keeping --shards runs reproducible
+// - A count near UINT16_MAX halves the node's counts, which keeps the ratios
+static void sample_average(Node *node, const float *strategy)
+{
+    uint64_t z = ((uint64_t)hash_key(&node->key) << 32) ^ (uint32_t)node->visits;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    float u = (z >> 40) * (1.0f / (1 << 24));
+
+    bool full = false;
+    for (int i = 0; i < node->action_count; i++)
+        full |= (node->avg_count[i] > UINT16_MAX - AVG_UNITS);
+    if (full) {
+        for (int i = 0; i < node->action_count; i++)
+            node->avg_count[i] >>= 1;
+    }
+
+    float cum = 0.0f;
+    int prev = 0;
+    for (int i = 0; i < node->action_count; i++) {
+        cum += strategy[i];
+        int edge = (i == node->action_count - 1) ? AVG_UNITS : (int)(cum * AVG_UNITS + u);
+        if (edge > AVG_UNITS) edge = AVG_UNITS;
+        node->avg_count[i] += edge - prev;
+        prev = edge;
+    }
+}
+#endif
+
+Node *lookup_node(Node **hash_table, const Key *key, uint16_t mask, int slice)
+{
+    Key k = *key;
+    long idx = idx_hash(&k, NODE_QTY) + (NODE_QTY * (long)slice);
+    for (Node *cur = hash_table[idx]; cur; cur = cur->next)
+        if (cur->mask == mask && key_equal(&cur->key, key))
+            return cur;
+    return NULL;
+}
+
 // Update strategy using regret matching
-// Writes current strategy into caller-provided buffer; accumulates strategy_sum
+// Writes current strategy into caller-provided buffer; accumulates the average strategy
 void update_strategy(Node *node, float *strategy)
 {
     float normalizing_sum = 0.0f;
@@ -98,12 +283,56 @@ void update_strategy(Node *node, float *strategy)
         } else {
             strategy[i] = 1.0f / node->action_count;
         }
+#ifndef SAMPLED_AVG
         node->strategy_sum[i] += strategy[i];
+#endif
     }
 
+#ifdef SAMPLED_AVG
+    sample_average(node, strategy);
+#endif
     node->visits++;
 }
 
+void node_average_sums(const Node *node, float *sums)
+{
+    for (int i = 0; i < node->action_count; i++) {
+#ifdef SAMPLED_AVG
+        sums[i] = node->avg_count[i] * (1.0f / AVG_UNITS);
+#else
+        sums[i] = node->strategy_sum[i];
+#endif
+    }
+}
+
+void node_add_average_sums(Node *node, const float *sums)
+{
+#ifdef SAMPLED_AVG
+    float total[MAX_ACTIONS], max = 0.0f;
+    for (int i = 0; i < node->action_count; i++) {
+        total[i] = node->avg_count[i] + sums[i] * AVG_UNITS;
+        if (total[i] < 0) total[i] = 0;
+        if (total[i] > max) max = total[i];
+    }
+    float scale = (max > UINT16_MAX - 1) ? (UINT16_MAX - 1) / max : 1.0f;
+    for (int i = 0; i < node->action_count; i++)
+        node->avg_count[i] = (uint16_t)(total[i] * scale + 0.5f);
+#else
+    for (int i = 0; i < node->action_count; i++)
+        node->strategy_sum[i] += sums[i];
+#endif
+}
+
+void node_average(const Node *node, float *avg)
+{
+    float sums[MAX_ACTIONS], total = 0.0f;
+    node_average_sums(node, sums);
+    for (int i = 0; i < node->action_count; i++)
+        total += sums[i];
+    for (int i = 0; i < node->action_count; i++)
+        avg[i] = (total > 0) ? sums[i] / total : 1.0f / node->action_count;
+}
+
 // Update regrets after action utilities are calculated
 void update_regrets(Node *node, float *action_utilities, float node_utility)
 {
@@ -122,6 +351,7 @@ float recurse(State *sp, Node **hash_table, int p, int thread_num)
         int payoff = score(sp);
         return (p == 0) ? payoff : -payoff;
     }
+    PROF_NODE(sp->stage, sp->trick_num);
     
     // Get legal actions
     UC actions[MAX_ACTIONS];
@@ -135,11 +365,16 @@ float recurse(State *sp, Node **hash_table, int p, int thread_num)
     
     // Build key and get/create node
     Key k = build_key(sp);
-    Node *node = get_or_create(hash_table, &k, actions, num_actions, thread_num);
+    Node *node = get_or_create(hash_table, &k, actions, num_actions,
+                               action_mask(actions, num_actions), thread_num);
+    count_visit();
     
     // Compute strategy into local buffer (recomputed each visit from regret_sum)
     float strategy[MAX_ACTIONS] = {0};
+    lock_node(node);
     update_strategy(node, strategy);
+    mark_dirty(node, thread_num);
+    unlock_node(node);
 
     // Calculate action utilities
     float action_utilities[MAX_ACTIONS] = {0};
@@ -161,8 +396,102 @@ float recurse(State *sp, Node **hash_table, int p, int thread_num)
     
     // Update regrets (only for current player's nodes)
     if (sp->to_act == p) {
+        lock_node(node);
         update_regrets(node, action_utilities, node_utility);
+        unlock_node(node);
     }
     
     return node_utility;
 }
+
+// One child subtree of a split node, run as a pool task
+typedef struct {
+    Task task;              // Must be first: the pool hands back a Task *
+    State next_state;
+    Node **hash_table;
+    int p;
+    int thread_num;
+    int split_depth;
+    float utility;
+} SubtreeTask;
+
+static void run_subtree(Task *t)
+{
+    SubtreeTask *st = (SubtreeTask *)t;
+    st->utility = recurse_split(&st->next_state, st->hash_table, st->p,
+                                st->thread_num, st->split_depth);
+}
+
+// CFR recursion with the top split_depth levels spawned as pool tasks
+// - Below the split depth this is plain recurse
+// - Child utilities land in fixed slots and are reduced in action order, so each
+//   node's utility and regret update are computed as in the sequential traversal
+//   from the values its children returned
+// - Sibling subtrees on one slice can reach the same node and update it
+//   concurrently under the striped locks, so the order of those updates (and so
+//   the trained values) can differ from the sequential traversal and between runs
+// - Requires cfr_set_shared(true) for those shared nodes
+float recurse_split(State *sp, Node **hash_table, int p, int thread_num, int split_depth)
+{
+    if (split_depth <= 0 || sp->hand_done)
+        return recurse(sp, hash_table, p, thread_num);
+
+    UC actions[MAX_ACTIONS];
+    int num_actions;
+
+    if (sp->stage == BID) {
+        num_actions = legal_bid(sp, actions);
+    } else {
+        num_actions = legal_play(sp, actions);
+    }
+
+    Key k = build_key(sp);
+    Node *node = get_or_create(hash_table, &k, actions, num_actions,
+                               action_mask(actions, num_actions), thread_num);
+    count_visit();
+
+    float strategy[MAX_ACTIONS] = {0};
+    lock_node(node);
+    update_strategy(node, strategy);
+    mark_dirty(node, thread_num);
+    unlock_node(node);
+
+    // Spawn siblings 1..n-1, run the first child on this thread, then wait
+    SubtreeTask sub[MAX_ACTIONS];
+    TaskGroup group;
+    pool_group_init(&group);
+
+    for (int i = 0; i < num_actions; i++) {
+        sub[i].next_state = *sp;
+        if (sp->stage == BID) {
+            apply_bid(&sub[i].next_state, actions[i]);
+        } else {
+            UC card_index = bind_card_index_to_action(&sub[i].next_state, actions[i]);
+            apply_play(&sub[i].next_state, card_index);
+        }
+        sub[i].task.fn = run_subtree;
+        sub[i].hash_table = hash_table;
+        sub[i].p = p;
+        sub[i].thread_num = thread_num;
+        sub[i].split_depth = split_depth - 1;
+        if (i > 0) pool_spawn(&group, &sub[i].task);
+    }
+    run_subtree(&sub[0].task);
+    pool_wait(&group);
+
+    // Deterministic reduction in action order
+    float action_utilities[MAX_ACTIONS] = {0};
+    float node_utility = 0.0f;
+    for (int i = 0; i < num_actions; i++) {
+        action_utilities[i] = sub[i].utility;
+        node_utility += strategy[i] * action_utilities[i];
+    }
+
+    if (sp->to_act == p) {
+        lock_node(node);
+        update_regrets(node, action_utilities, node_utility);
+        unlock_node(node);
+    }
+
+    return node_utility;
+}
@@ -3,6 +3,7 @@
 #ifndef CFR_H
 #define CFR_H
 
+#include <stdatomic.h>
 #include "types.h"
 
 // Hash table configuration
@@ -15,13 +16,54 @@ unsigned int hash_key(Key *k);
 unsigned int idx_hash(Key *k, int size);
 
 // Node management
-Node *get_or_create(Node **pa, Key *key, UC actions[], UC legal_n, int thread_num);
+// - mask is action_mask(actions, legal_n); actions must be in bit order (as legal_bid
+//   and legal_play list them)
+Node *get_or_create(Node **pa, Key *key, UC actions[], UC legal_n, uint16_t mask, int thread_num);
+
+// Live node counts per slice (for the --max-mem budget)
+// - Allocation overhead is included: NODE_BYTES is the heap chunk one node occupies
+#define NODE_BYTES ((sizeof(Node) + sizeof(size_t) + 15) & ~(size_t)15)
+void cfr_init_counts(int slices);
+long cfr_slice_nodes(int slice);
+long cfr_slice_buckets(int slice);   // Non-empty buckets
+void cfr_release_nodes(int slice, long nodes, long buckets);
+
+// Dirty tracking (Node.dirty) for --procs syncs and --snapshot-delta
+// - Training sets a node's dirty flag when it updates the node; once cfr_track_dirty
+//   has run, the update that sets a clear flag also appends the node's key and mask
+//   to its slice's list, so consumers visit only changed nodes, not the whole table
+// - cfr_take_dirty hands over a slice's list (caller frees) and starts a new one;
+//   call it only while training is stopped. Entries may repeat, and their node may
+//   have been evicted or already cleared, so look each up (lookup_node) and check
+//   the flag; consumers clear the flags of the nodes they take
+typedef struct {
+    Key key;
+    uint16_t mask;
+} DirtyKey;
+void cfr_track_dirty(int slices);
+long cfr_take_dirty(int slice, DirtyKey **keys);
+
+// Node in slice with this key and legal action mask, or NULL
+Node *lookup_node(Node **hash_table, const Key *key, uint16_t mask, int slice);
+
+// Per-thread node-visit counter for telemetry (NULL = not counted); see stats.h
+void cfr_set_visit_counter(atomic_long *counter);
+
+// Shared-slice mode: one table slice used by many threads at once (see recurse_split)
+void cfr_set_shared(bool shared);
 
 // CFR algorithm
 float recurse(State *sp, Node **hash_table, int p, int thread_num);
+float recurse_split(State *sp, Node **hash_table, int p, int thread_num, int split_depth);
 
 // Regret matching
 void update_strategy(Node *node, float *strategy);
+
+// Average strategy accumulator, as per-action sums (either build)
+// - node_average normalizes them; uniform if nothing has accumulated yet
+void node_average_sums(const Node *node, float *sums);
+void node_add_average_sums(Node *node, const float *sums);
+void node_average(const Node *node, float *avg);
 void update_regrets(Node *node, float *action_utilities, float node_utility);
 
 #endif // CFR_H
@@ -0,0 +1,213 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include "checkpoint.h"
+#include "cfr.h"
+#include "key.h"
+#include "game.h"
+
+// Records buffered per fwrite/fread
+#define CKPT_CHUNK 65536
+
+// Buffered record writer shared by the chain walk
+// - chain holds one bucket's nodes so they can be written tail first
+typedef struct {
+    FILE *fp;
+    CheckpointRecord *buf;
+    long n;
+    long total;
+    int rc;
+    Node **chain;
+    long chain_cap;
+} RecordWriter;
+
+// Buffer one record; nothing more is written once a write has failed
+static void emit_record(RecordWriter *w, Node *cur, int slice)
+{
+    if (w->rc != 0) return;
+    CheckpointRecord *r = &w->buf[w->n++];
+    memset(r, 0, sizeof(*r));
+    memcpy(r->key, cur->key.bits, KEY_BYTES);
+    r->action_count = cur->action_count;
+    memcpy(r->action, cur->action, MAX_ACTIONS);
+    r->slice = slice;
+    memcpy(r->regret_sum, cur->regret_sum, sizeof(r->regret_sum));
+    node_average_sums(cur, r->strategy_sum);
+    r->visits = cur->visits;
+
+    if (w->n == CKPT_CHUNK) {
+        if (fwrite(w->buf, sizeof(CheckpointRecord), w->n, w->fp) != (size_t)w->n) w->rc = -1;
+        w->total += w->n;
+        w->n = 0;
+    }
+}
+
+// Put a record's actions (and their sums) in bit order
+// - Nodes list actions in bit order, but checkpoints from older builds may not
+static void order_record(CheckpointRecord *r)
+{
+    UC order[MAX_ACTIONS], action[MAX_ACTIONS];
+    float regret[MAX_ACTIONS], strategy[MAX_ACTIONS];
+    action_order(r->action, r->action_count, order);
+    for (int j = 0; j < r->action_count; j++) {
+        action[j] = r->action[order[j]];
+        regret[j] = r->regret_sum[order[j]];
+        strategy[j] = r->strategy_sum[order[j]];
+    }
+    memcpy(r->action, action, r->action_count);
+    memcpy(r->regret_sum, regret, r->action_count * sizeof(float));
+    memcpy(r->strategy_sum, strategy, r->action_count * sizeof(float));
+}
+
+// Emit a chain tail first: get_or_create prepends, so reloading restores the
+// original chain order and a resumed --shards run stays bit-identical
+// - The chain is copied into w->chain and walked backwards, so long chains need
+//   no recursion
+static void emit_chain(RecordWriter *w, Node *cur, int slice)
+{
+    long len = 0;
+    for (; cur && w->rc == 0; cur = cur->next) {
+        if (len == w->chain_cap) {
+            long cap = w->chain_cap ? w->chain_cap * 2 : 64;
+            Node **chain = realloc(w->chain, cap * sizeof(Node *));
+            if (!chain) {
+                fprintf(stderr, "Error: Cannot allocate a checkpoint chain of %ld nodes\n", cap);
+                w->rc = -1;
+                return;
+            }
+            w->chain = chain;
+            w->chain_cap = cap;
+        }
+        w->chain[len++] = cur;
+    }
+    while (len > 0 && w->rc == 0)
+        emit_record(w, w->chain[--len], slice);
+}
+
+// Write the whole table to filename
+// - Written to filename.tmp and renamed, so an interrupted write never replaces
+//   the previous good checkpoint
+int write_checkpoint(const char *filename, Node **hash_table, int slices, const CheckpointInfo *info)
+{
+    char tmp_name[4096];
+    snprintf(tmp_name, sizeof(tmp_name), "%s.tmp", filename);
+
+    FILE *fp = fopen(tmp_name, "wb");
+    if (!fp) {
+        fprintf(stderr, "Error: Cannot open checkpoint %s for writing\n", tmp_name);
+        return -1;
+    }
+
+    CheckpointHeader h = {0};
+    h.magic = CKPT_MAGIC;
+    h.version = CKPT_VERSION;
+    h.record_size = sizeof(CheckpointRecord);
+    h.slices = slices;
+    h.base_seed = info->base_seed;
+    h.shards = info->shards;
+    h.deals_done = info->deals_done;
+    RecordWriter w = { fp, malloc(CKPT_CHUNK * sizeof(CheckpointRecord)), 0, 0, 0, NULL, 0 };
+    if (fwrite(&h, sizeof(h), 1, fp) != 1) w.rc = -1;   // node_count patched below
+    if (!w.buf) {
+        fprintf(stderr, "Error: Cannot allocate checkpoint buffer\n");
+        fclose(fp);
+        return -1;
+    }
+
+    for (int t = 0; t < slices && w.rc == 0; t++) {
+        for (long i = 0; i < NODE_QTY && w.rc == 0; i++)
+            emit_chain(&w, hash_table[(long)t * NODE_QTY + i], t);
+    }
+    if (w.rc == 0 && w.n > 0) {
+        if (fwrite(w.buf, sizeof(CheckpointRecord), w.n, fp) != (size_t)w.n) w.rc = -1;
+        w.total += w.n;
+    }
+    free(w.buf);
+    free(w.chain);
+    int rc = w.rc;
+    long total = w.total;
+
+    h.node_count = total;
+    if (rc == 0) {
+        fseek(fp, 0, SEEK_SET);
+        if (fwrite(&h, sizeof(h), 1, fp) != 1) rc = -1;
+    }
+    if (fclose(fp) != 0) rc = -1;
+
+    if (rc != 0) {
+        fprintf(stderr, "Error: Write failed on checkpoint %s\n", tmp_name);
+        remove(tmp_name);
+        return -1;
+    }
+    if (rename(tmp_name, filename) != 0) {
+        fprintf(stderr, "Error: Cannot rename %s to %s\n", tmp_name, filename);
+        return -1;
+    }
+
+    printf("Checkpoint: %ld nodes, %ld deals -> %s\n", total, info->deals_done, filename);
+    return 0;
+}
+
+// Load a checkpoint into an empty table
+// - Records go back to their slice, folded modulo slices when resuming with fewer;
+//   nodes that land on the same key and actions have their sums added
+int read_checkpoint(const char *filename, Node **hash_table, int slices, CheckpointInfo *info)
+{
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) {
+        fprintf(stderr, "Error: Cannot open checkpoint %s\n", filename);
+        return -1;
+    }
+
+    CheckpointHeader h;
+    if (fread(&h, sizeof(h), 1, fp) != 1 || h.magic != CKPT_MAGIC) {
+        fprintf(stderr, "Error: %s is not a checkpoint file\n", filename);
+        fclose(fp);
+        return -1;
+    }
+    if (h.version != CKPT_VERSION || h.record_size != sizeof(CheckpointRecord)) {
+        fprintf(stderr, "Error: %s has version %u, record size %u (expected %d, %zu)\n",
+                filename, h.version, h.record_size, CKPT_VERSION, sizeof(CheckpointRecord));
+        fclose(fp);
+        return -1;
+    }
+    if (h.slices != (uint32_t)slices)
+        printf("Checkpoint has %u slices, folding into %d\n", h.slices, slices);
+
+    CheckpointRecord *buf = malloc(CKPT_CHUNK * sizeof(CheckpointRecord));
+    if (!buf) {
+        fprintf(stderr, "Error: Cannot allocate checkpoint buffer\n");
+        fclose(fp);
+        return -1;
+    }
+
+    long loaded = 0;
+    size_t n;
+    while ((n = fread(buf, sizeof(CheckpointRecord), CKPT_CHUNK, fp)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            CheckpointRecord *r = &buf[i];
+            Key k = key_from_bits(r->key);
+            order_record(r);
+            Node *node = get_or_create(hash_table, &k, r->action, r->action_count,
+                                       action_mask(r->action, r->action_count),
+                                       r->slice % slices);
+            for (int j = 0; j < r->action_count; j++)
+                node->regret_sum[j] += r->regret_sum[j];
+            node_add_average_sums(node, r->strategy_sum);
+            node->visits += r->visits;
+        }
+        loaded += n;
+    }
+    free(buf);
+    fclose(fp);
+
+    if (loaded != h.node_count) {
+        fprintf(stderr, "Error: Read %ld of %ld nodes from %s\n", loaded, (long)h.node_count, filename);
+        return -1;
+    }
+
+    info->base_seed = h.base_seed;
+    info->shards = h.shards;
+    info->deals_done = h.deals_done;
+    printf("Resumed %ld nodes, %ld deals from %s\n", loaded, info->deals_done, filename);
+    return 0;
+}
@@ -0,0 +1,45 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "types.h"
+
+// Checkpoint file: full training state (regret and strategy sums, visits) so a
+// run can be resumed after a crash or preemption, or extended with more deals
+// - Header, then one CheckpointRecord per node in slice/bucket/chain order
+#define CKPT_MAGIC 0x54504b43u  // 'C','K','P','T'
+#define CKPT_VERSION 1
+
+typedef struct {
+    uint32_t magic;         // CKPT_MAGIC
+    uint32_t version;       // CKPT_VERSION
+    uint32_t record_size;   // sizeof(CheckpointRecord) — reader validates layout
+    uint32_t slices;        // Table slices in the writing run
+    uint32_t base_seed;     // Deal streams continue from this seed on resume
+    uint32_t shards;        // Deterministic shard count (0 = off)
+    int64_t  deals_done;    // Deals [0, deals_done) are included
+    int64_t  node_count;    // Records following the header
+} CheckpointHeader;
+
+typedef struct {
+    UC key[KEY_BYTES];      // Key bytes (the in-memory Key's padding is not stored)
+    UC action_count;
+    UC action[MAX_ACTIONS];
+    uint32_t slice;
+    float regret_sum[MAX_ACTIONS];
+    float strategy_sum[MAX_ACTIONS];
+    int visits;
+} CheckpointRecord;
+
+// Run-level state saved with the table
+typedef struct {
+    unsigned int base_seed;
+    int shards;
+    long deals_done;
+} CheckpointInfo;
+
+int write_checkpoint(const char *filename, Node **hash_table, int slices, const CheckpointInfo *info);
+int read_checkpoint(const char *filename, Node **hash_table, int slices, CheckpointInfo *info);
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,262 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include <unistd.h>
+#include <errno.h>
+#include "coord.h"
+#include "cfr.h"
+#include "checkpoint.h"
+#include "key.h"
+#include "game.h"
+
+// Records per socket write on the worker side
+#define COORD_CHUNK 65536
+
+static int write_all(int fd, const void *buf, size_t len)
+{
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int read_all(int fd, void *buf, size_t len)
+{
+    char *p = buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static void node_to_record(const Node *cur, CheckpointRecord *r)
+{
+    memset(r, 0, sizeof(*r));
+    memcpy(r->key, cur->key.bits, KEY_BYTES);
+    r->action_count = cur->action_count;
+    memcpy(r->action, cur->action, MAX_ACTIONS);
+    memcpy(r->regret_sum, cur->regret_sum, sizeof(r->regret_sum));
+    node_average_sums(cur, r->strategy_sum);
+    r->visits = cur->visits;
+}
+
+// Overwrite a node with the values in r
+static void set_node(Node *node, const CheckpointRecord *r)
+{
+    float cur[MAX_ACTIONS], diff[MAX_ACTIONS];
+    node_average_sums(node, cur);
+    for (int j = 0; j < r->action_count; j++) {
+        node->regret_sum[j] = r->regret_sum[j];
+        diff[j] = r->strategy_sum[j] - cur[j];
+    }
+    node_add_average_sums(node, diff);
+    node->visits = r->visits;
+    node->dirty = 0;
+}
+
+// Send the nodes on every slice's dirty list, slice by slice in list order
+// - A node's flag is cleared the first time it is seen, which also skips repeats
+int coord_send_dirty(int fd, Node **hash_table, int slices)
+{
+    DirtyKey **lists = calloc(slices, sizeof(DirtyKey *));
+    long *counts = calloc(slices, sizeof(long));
+    long total = 0;
+    for (int t = 0; lists && counts && t < slices; t++) {
+        counts[t] = cfr_take_dirty(t, &lists[t]);
+        total += counts[t];
+    }
+    Node **nodes = (lists && counts) ? malloc((total ? total : 1) * sizeof(Node *)) : NULL;
+    CheckpointRecord *buf = malloc(COORD_CHUNK * sizeof(CheckpointRecord));
+    int rc = (nodes && buf) ? 0 : -1;
+
+    int64_t count = 0;
+    for (int t = 0; rc == 0 && t < slices; t++) {
+        for (long i = 0; i < counts[t]; i++) {
+            Node *cur = lookup_node(hash_table, &lists[t][i].key, lists[t][i].mask, t);
+            if (!cur || !cur->dirty) continue;
+            cur->dirty = 0;
+            nodes[count++] = cur;
+        }
+    }
+    if (rc == 0) rc = write_all(fd, &count, sizeof(count));
+
+    long n = 0;
+    for (int64_t i = 0; i < count && rc == 0; i++) {
+        node_to_record(nodes[i], &buf[n++]);
+        if (n == COORD_CHUNK) {
+            rc = write_all(fd, buf, n * sizeof(CheckpointRecord));
+            n = 0;
+        }
+    }
+    if (rc == 0 && n > 0) rc = write_all(fd, buf, n * sizeof(CheckpointRecord));
+
+    for (int t = 0; lists && counts && t < slices; t++)
+        free(lists[t]);
+    free(lists);
+    free(counts);
+    free(nodes);
+    free(buf);
+    return rc;
+}
+
+int coord_recv_updates(int fd, Node **hash_table, int slices)
+{
+    int64_t count;
+    if (read_all(fd, &count, sizeof(count)) != 0) return -1;
+
+    CheckpointRecord *buf = malloc(COORD_CHUNK * sizeof(CheckpointRecord));
+    if (!buf) return -1;
+    int rc = 0;
+    for (int64_t done = 0; done < count && rc == 0; ) {
+        long n = (count - done < COORD_CHUNK) ? (long)(count - done) : COORD_CHUNK;
+        rc = read_all(fd, buf, n * sizeof(CheckpointRecord));
+        for (long i = 0; i < n && rc == 0; i++) {
+            // Every slice gets the node, so no slice later builds on a stale zero copy
+            Key k = key_from_bits(buf[i].key);
+            uint16_t mask = action_mask(buf[i].action, buf[i].action_count);
+            for (int t = 0; t < slices; t++) {
+                Node *node = get_or_create(hash_table, &k, buf[i].action,
+                                           buf[i].action_count, mask, t);
+                set_node(node, &buf[i]);
+            }
+        }
+        done += n;
+    }
+    free(buf);
+    return rc;
+}
+
+// Summed worker deltas of one information set
+// - Float in both builds: a SAMPLED_AVG node cannot hold the negative average-sum
+//   deltas of a worker whose counts were rescaled, and clamping them would lose them
+typedef struct Delta {
+    Key key;
+    uint16_t mask;
+    UC action_count;
+    UC action[MAX_ACTIONS];
+    float regret_sum[MAX_ACTIONS];
+    float strategy_sum[MAX_ACTIONS];
+    int visits;
+    struct Delta *next;     // Bucket chain
+    struct Delta *made;     // Every delta of the round, newest first
+} Delta;
+
+// Delta table, bucketed like a table slice; phase 2 walks the made list instead of
+// the buckets, so a round costs in proportion to the nodes the workers changed
+static Delta **deltas = NULL;
+static Delta *made = NULL;
+
+static Delta *get_delta(const CheckpointRecord *r, const Key *k, uint16_t mask, long *created)
+{
+    Key kk = *k;
+    long idx = idx_hash(&kk, NODE_QTY);
+    for (Delta *d = deltas[idx]; d; d = d->next)
+        if (d->mask == mask && key_equal(&d->key, k)) return d;
+    Delta *d = calloc(1, sizeof(Delta));
+    if (!d) {
+        fprintf(stderr, "Error: Out of memory creating a sync delta\n");
+        exit(1);
+    }
+    d->key = *k;
+    d->mask = mask;
+    d->action_count = r->action_count;
+    memcpy(d->action, r->action, MAX_ACTIONS);
+    d->next = deltas[idx];
+    deltas[idx] = d;
+    d->made = made;
+    made = d;
+    (*created)++;
+    return d;
+}
+
+// Phase 1: add one worker's deltas (its values minus the pooled values) to the
+// delta table
+static int gather_worker(int fd, Node **shared, CheckpointRecord *buf, long *changed)
+{
+    int64_t count;
+    if (read_all(fd, &count, sizeof(count)) != 0) return -1;
+
+    for (int64_t done = 0; done < count; ) {
+        long n = (count - done < COORD_CHUNK) ? (long)(count - done) : COORD_CHUNK;
+        if (read_all(fd, buf, n * sizeof(CheckpointRecord)) != 0) return -1;
+        for (long i = 0; i < n; i++) {
+            CheckpointRecord *r = &buf[i];
+            Key k = key_from_bits(r->key);
+            uint16_t mask = action_mask(r->action, r->action_count);
+            Node *base = get_or_create(shared, &k, r->action, r->action_count, mask, 0);
+            Delta *sum = get_delta(r, &k, mask, changed);
+            float avg[MAX_ACTIONS];
+            node_average_sums(base, avg);
+            for (int j = 0; j < r->action_count; j++) {
+                sum->regret_sum[j] += r->regret_sum[j] - base->regret_sum[j];
+                sum->strategy_sum[j] += r->strategy_sum[j] - avg[j];
+            }
+            sum->visits += r->visits - base->visits;
+        }
+        done += n;
+    }
+    return 0;
+}
+
+long coord_reduce(int *fds, int procs, Node **shared)
+{
+    if (!deltas) deltas = calloc(NODE_QTY, sizeof(Delta *));
+    CheckpointRecord *buf = malloc(COORD_CHUNK * sizeof(CheckpointRecord));
+    if (!deltas || !buf) {
+        fprintf(stderr, "Error: Cannot allocate the sync delta table\n");
+        free(buf);
+        return -1;
+    }
+    long changed = 0;
+    for (int w = 0; w < procs; w++) {
+        if (gather_worker(fds[w], shared, buf, &changed) != 0) {
+            fprintf(stderr, "Error: Lost worker %d during sync\n", w);
+            free(buf);
+            return -1;
+        }
+    }
+    free(buf);
+
+    // Phase 2: apply the summed deltas (newest first) and collect the new values
+    CheckpointRecord *out = malloc((changed ? changed : 1) * sizeof(CheckpointRecord));
+    if (!out) {
+        fprintf(stderr, "Error: Cannot allocate %ld sync records\n", changed);
+        return -1;
+    }
+    long n = 0;
+    while (made) {
+        Delta *cur = made;
+        Node *base = get_or_create(shared, &cur->key, cur->action, cur->action_count, cur->mask, 0);
+        for (int j = 0; j < cur->action_count; j++)
+            base->regret_sum[j] += cur->regret_sum[j];
+        // The summed delta is added once, so a SAMPLED_AVG count only clamps at 0 if
+        // the pooled value itself would go negative
+        node_add_average_sums(base, cur->strategy_sum);
+        base->visits += cur->visits;
+        node_to_record(base, &out[n++]);
+
+        deltas[idx_hash(&cur->key, NODE_QTY)] = NULL;
+        made = cur->made;
+        free(cur);
+    }
+
+    int64_t count = n;
+    for (int w = 0; w < procs; w++) {
+        if (write_all(fds[w], &count, sizeof(count)) != 0 ||
+            write_all(fds[w], out, n * sizeof(CheckpointRecord)) != 0) {
+            fprintf(stderr, "Error: Lost worker %d during sync\n", w);
+            free(out);
+            return -1;
+        }
+    }
+    free(out);
+    return n;
+}
@@ -0,0 +1,32 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#ifndef COORD_H
+#define COORD_H
+
+#include "types.h"
+
+// Multi-process training (--procs)
+// - The parent is the coordinator: it holds the pooled table and no training threads.
+//   Each worker process trains its own deal range, then at every sync:
+//   1. the worker sends the absolute values of every node it touched since the last
+//      sync (its slices' dirty lists, see cfr_track_dirty) over its Unix socket
+//   2. the coordinator turns them into deltas against the pooled table, sums the
+//      deltas of all workers in worker order as floats, then adds the sum to the
+//      pooled table
+//   3. the coordinator sends the new absolute values of every changed node back to
+//      every worker, which overwrites its copy in every slice
+// - Between syncs each worker trains on pooled regrets plus its own updates, and
+//   after a sync all workers hold identical tables
+// - Messages are an int64 record count followed by CheckpointRecords, so the same
+//   stream could be carried over TCP between hosts
+
+// Worker side
+int coord_send_dirty(int fd, Node **hash_table, int slices);
+int coord_recv_updates(int fd, Node **hash_table, int slices);
+
+// Coordinator side: one full sync round over fds[0..procs-1]; pooled values live in
+// the one slice of shared
+// - Returns the number of nodes changed, or -1 if a worker failed
+long coord_reduce(int *fds, int procs, Node **shared);
+
+#endif // COORD_H
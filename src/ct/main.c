@@ -4,10 +4,24 @@
 #include <stdlib.h>
 #include <time.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <signal.h>
 #include "types.h"
 #include "cfr.h"
+#include "pool.h"
+#include "checkpoint.h"
+#include "table.h"
+#include "output.h"
+#include "coord.h"
+#include "stats.h"
 #include "deck.h"
 #include "util.h"
+#include "prof.h"
 
 // Global configuration
 typedef struct {
@@ -16,34 +30,187 @@ typedef struct {
     int visit_threshold;
     char *output_file;
     unsigned int base_seed;
+    int split_depth;        // Tree levels spawned as pool tasks (0 = one thread per deal)
+    int shards;             // Deterministic mode: fixed deal shards, one slice each (0 = off)
+    char *checkpoint_file;  // Full training state written here (NULL = off)
+    long checkpoint_every;  // Deals between checkpoints (0 = only at the end)
+    char *resume_file;      // Checkpoint to restart from (NULL = fresh run)
+    char *snapshot_prefix;  // Background strategy snapshots written as <prefix>.<deals>.bin
+    long snapshot_every;    // Deals between snapshots (0 = off)
+    float snapshot_delta;   // Delta snapshot epsilon (< 0 = full snapshots from a fork)
+    double time_limit;      // Wall-clock budget in seconds (0 = none)
+    double converge_eps;    // Stop once both stages' average regret is below this (0 = off)
+    long sample_every;      // Deals between convergence samples
+    char *trace_file;       // Convergence trace CSV (NULL = off)
+    char *warm_file;        // Strategy file to seed the table from (NULL = empty start)
+    char warm_format;       // 'S' = Strat, 'Q' = Strat_255
+    float warm_weight;      // Pseudo-visits of average strategy credited to the prior
+    float warm_regret;      // Synthetic regret scale (0 = none)
+    long max_mem;           // Table memory budget in MB (0 = unlimited)
+    bool sorted;            // Write sorted, deduplicated output (see output.c)
+    char out_format;        // Sorted output records: 'S' = Strat, 'Q' = Strat_255
+    int procs;              // Worker processes pooling regrets via the parent (0 = off)
+    long sync_every;        // Deals between --procs syncs
+    double stats_every;     // Seconds between telemetry reports (0 = SIGUSR1 only)
+    char *stats_csv;        // Telemetry CSV (NULL = off)
+    bool hash_report;       // Print hash table diagnostics before saving
 } Config;
 
+// Eviction frees nodes until a slice is this fraction of its budget, so it runs
+// once per few hundred deals rather than after every deal
+#define EVICT_LOW_WATER 0.9
+
+// When eviction leaves a slice over budget, its next attempt waits for this
+// fraction of the budget in new nodes instead of rescanning after every deal
+#define EVICT_BACKOFF 0.05
+
+// Deals claimed per trip to the shared scheduler counter
+// - Small enough that threads finish close together, large enough to keep the atomic cold
+#ifndef DEAL_BATCH
+#define DEAL_BATCH 4
+#endif
+
+// With --shards and --time-limit, deals per shard in each segment; the deadline
+// is checked between segments, where every shard has trained the same deal prefix
+#define SHARD_TIME_DEALS 8
+
+// Work scheduler shared by all training threads
+// - Indices [next, end) are handed out in batches from an atomic counter
+// - Normally the indices are deals, claimed DEAL_BATCH at a time; deal tree sizes
+//   vary widely, so a static split leaves cores idle at the end
+// - In deterministic mode the indices are shards, claimed one at a time
+typedef struct {
+    atomic_long next;   // Next unclaimed index
+    long end;           // One past the last index
+    long batch;         // Indices per claim
+} Scheduler;
+
 // Thread data
 typedef struct {
     int thread_id;
-    int iterations_per_thread;
+    int slice;          // Hash table slice (thread_id, or 0 when the slice is shared)
+    int split_depth;
+    int shards;
+    long deal_begin;    // Deal range for this run; shards walk it with stride shards
+    long deal_end;
+    Scheduler *sched;
+    atomic_int *active; // Threads still claiming deals
     Node **hash_table;
-    unsigned int seed;
+    unsigned int base_seed;
+    double deadline;    // Monotonic time at which to stop claiming work (0 = none)
+    long deals_done;    // Deals trained by this thread (for the end-of-run report)
+    long node_budget;   // Max nodes per slice (0 = unlimited)
+    long evicted;       // Nodes evicted by this thread
+    int evict_cutoff;   // Highest visit cutoff this thread has evicted below
+    long *evict_rearm;  // Per slice: node count at which eviction is next tried
+    ThreadCounters *counters;  // This thread's telemetry slot
 } ThreadData;
 
+// Monotonic wall clock in seconds
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Claim the next batch of deal indices; returns false once all deals are handed out
+static bool claim_batch(Scheduler *sched, long *start, long *stop)
+{
+    long first = atomic_fetch_add_explicit(&sched->next, sched->batch, memory_order_relaxed);
+    if (first >= sched->end) return false;
+    *start = first;
+    *stop = (first + sched->batch < sched->end) ? first + sched->batch : sched->end;
+    return true;
+}
+
+// Train one deal: both players traverse the same dealt hands
+// - The deal stream depends only on (base seed, deal index), not on which thread claims it
+static void train_deal(ThreadData *data, long deal, int slice)
+{
+    Rng rng;
+    rng_init(&rng, data->base_seed, (uint64_t)deal);
+
+    State s = {0};
+    s.seed = (unsigned int)rng_next(&rng);
+    s.dealer = rng_bounded(&rng, 2);
+    s.stage = BID;
+    s.to_act = 1 - s.dealer; // Non-dealer bids first
+    s.trump = PRE_TRUMP; 
+
+    deal_hands(&s, &rng);
+
+    if (data->split_depth > 0) {
+        recurse_split(&s, data->hash_table, 0, slice, data->split_depth);
+        recurse_split(&s, data->hash_table, 1, slice, data->split_depth);
+    } else {
+        recurse(&s, data->hash_table, 0, slice);
+        recurse(&s, data->hash_table, 1, slice);
+    }
+
+    // The slice is private to this thread between deals, so it can be pruned here
+    long nodes = cfr_slice_nodes(slice);
+    if (data->node_budget > 0 && nodes > data->node_budget && nodes >= data->evict_rearm[slice]) {
+        int cutoff;
+        data->evicted += evict_cold_nodes(data->hash_table, slice,
+                                          (long)(data->node_budget * EVICT_LOW_WATER), &cutoff);
+        if (cutoff > data->evict_cutoff) data->evict_cutoff = cutoff;
+        nodes = cfr_slice_nodes(slice);
+        if (nodes > data->node_budget) {
+            data->evict_rearm[slice] = nodes + (long)(data->node_budget * EVICT_BACKOFF) + 1;
+            static atomic_flag warned = ATOMIC_FLAG_INIT;
+            if (!atomic_flag_test_and_set(&warned))
+                fprintf(stderr, "Warning: --max-mem cannot be met; slice %d still holds %ld nodes "
+                                "(budget %ld)\n", slice, nodes, data->node_budget);
+        }
+    }
+
+    atomic_store_explicit(&data->counters->deals,
+                          atomic_load_explicit(&data->counters->deals, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+}
+
+// Train every deal of one shard in increasing deal order on the shard's own slice
+// - Deal i belongs to shard i % shards, so the updates each slice sees, and their
+//   order, do not depend on the thread count or on which thread runs the shard
+static long train_shard(ThreadData *data, int shard)
+{
+    long first = data->deal_begin + ((shard - data->deal_begin % data->shards) + data->shards) % data->shards;
+    long n = 0;
+    for (long deal = first; deal < data->deal_end; deal += data->shards) {
+        train_deal(data, deal, shard);
+        n++;
+    }
+    return n;
+}
+
 // Thread function for CFR training
 void *train_thread(void *arg)
 {
     ThreadData *data = (ThreadData *)arg;
+    long start, stop;
+    cfr_set_visit_counter(&data->counters->visits);
     
-    for (int i = 0; i < data->iterations_per_thread; i++) {
-        State s = {0};
-        s.seed = data->seed + i;
-        s.dealer = get_random(0, 1, &s.seed);
-        s.stage = BID;
-        s.to_act = 1 - s.dealer; // Non-dealer bids first
-        s.trump = PRE_TRUMP; 
-
-        make_cards_and_deal(&s);
-        
-        recurse(&s, data->hash_table, 0, data->thread_id);
-        recurse(&s, data->hash_table, 1, data->thread_id);
+    // The deadline is checked before each claim, so claimed batches always finish and
+    // the trained deals stay a prefix of the deal sequence
+    // - A shard claim is a slice of the whole segment, so shards only stop between
+    //   segments (see run_segment)
+    while ((data->shards > 0 || data->deadline == 0 || now_seconds() < data->deadline) &&
+           claim_batch(data->sched, &start, &stop)) {
+        if (data->shards > 0) {
+            for (long i = start; i < stop; i++)
+                data->deals_done += train_shard(data, (int)i);
+        } else {
+            for (long i = start; i < stop; i++)
+                train_deal(data, i, data->slice);
+            data->deals_done += stop - start;
+        }
     }
+
+    // Out of deals: help finish other threads' subtrees
+    atomic_fetch_sub(data->active, 1);
+    if (data->split_depth > 0)
+        pool_help(data->active);
     
     return NULL;
 }
@@ -72,22 +239,12 @@ void save_strategy_file(Node **hash_table, int threads, const char *filename, in
                     continue;
                 }    
                 Strat strat = {0};
-                memcpy(&strat.bits, &cur->key.bits, sizeof(Key));
+                memcpy(&strat.bits, &cur->key.bits, KEY_BYTES);
                 strat.action_count = cur->action_count;
                 memcpy(strat.action, cur->action, MAX_ACTIONS);
+                strat.mask = cur->mask;
                 
-                float strategy_sum = 0.0f;
-                for (int j = 0; j < cur->action_count; j++) {
-                    strategy_sum += cur->strategy_sum[j];
-                }
-                
-                for (int j = 0; j < cur->action_count; j++) {
-                    if (strategy_sum > 0) {
-                        strat.strategy[j] = cur->strategy_sum[j] / strategy_sum;
-                    } else {
-                        strat.strategy[j] = 1.0f / cur->action_count;
-                    }
-                }
+                node_average(cur, strat.strategy);
                 
                 fwrite(&strat, sizeof(Strat), 1, fp);
                 total_nodes++;
@@ -101,20 +258,376 @@ void save_strategy_file(Node **hash_table, int threads, const char *filename, in
     printf("Saved %ld nodes to %s\n", total_nodes, filename);
 }
 
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [options] <threads> <iterations> <visit threshold> <output_file> <seed>\n", prog);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --split-depth N   spawn the top N tree levels of each deal as parallel tasks\n");
+    fprintf(stderr, "                    on one shared table slice (2 = bids, 4 = bids + first trick)\n");
+    fprintf(stderr, "  --shards N        deterministic mode: deal i trains on slice i %% N in deal order,\n");
+    fprintf(stderr, "                    so output is bit-identical for any thread count\n");
+    fprintf(stderr, "  --checkpoint F    write full regret/strategy sums to F at the end of the run\n");
+    fprintf(stderr, "  --checkpoint-every N  also checkpoint every N deals\n");
+    fprintf(stderr, "  --resume F        restart from checkpoint F and train up to <iterations> deals\n");
+    fprintf(stderr, "  --snapshot-every N  write the average strategy every N deals from a forked\n");
+    fprintf(stderr, "                    child while training continues\n");
+    fprintf(stderr, "  --snapshot-prefix P  snapshot files are P.<deals>.bin (default: output_file)\n");
+    fprintf(stderr, "  --snapshot-delta E  after the first snapshot, write P.<deals>.delta.bin with\n");
+    fprintf(stderr, "                    only nodes that are new or moved by more than E (see ct-compact)\n");
+    fprintf(stderr, "  --time-limit S    stop after S seconds of training (<iterations> is the cap)\n");
+    fprintf(stderr, "  --converge E      stop once average positive regret per visit is below E\n");
+    fprintf(stderr, "                    for both bid and play nodes\n");
+    fprintf(stderr, "  --sample-every N  deals between convergence samples (default 1000)\n");
+    fprintf(stderr, "  --trace F         append each convergence sample to CSV file F\n");
+    fprintf(stderr, "  --warm-start F    seed the table from strategy file F\n");
+    fprintf(stderr, "  --warm-format S|Q F is Strat (ct output) or Strat_255 (kwayp output, default)\n");
+    fprintf(stderr, "  --warm-weight W   strategy_sum = p * W (default 100)\n");
+    fprintf(stderr, "  --warm-regret R   also set regret_sum = p * R so play starts from the prior\n");
+    fprintf(stderr, "  --max-mem MB      cap table memory; the least-visited nodes are evicted\n");
+    fprintf(stderr, "  --sorted          merge slices and write sorted, deduplicated Strat output\n");
+    fprintf(stderr, "  --out-format S|Q  sorted output as Strat (S) or quantized Strat_255 (Q);\n");
+    fprintf(stderr, "                    implies --sorted\n");
+    fprintf(stderr, "  --procs P         train in P worker processes that pool regrets through\n");
+    fprintf(stderr, "                    this process\n");
+    fprintf(stderr, "  --sync-every N    deals between --procs syncs (default 100)\n");
+    fprintf(stderr, "  --stats-every S   report throughput and table occupancy to stderr every\n");
+    fprintf(stderr, "                    S seconds (SIGUSR1 reports at any time)\n");
+    fprintf(stderr, "  --stats-csv F     append each report to CSV file F\n");
+    fprintf(stderr, "  --hash-report     print chain-length and collision diagnostics at the end\n");
+}
+
+// Write the strategy in the configured output format
+static void save_output(Config *config, Node **hash_table, int slices, const char *filename)
+{
+    if (config->sorted)
+        save_sorted_strategy(hash_table, slices, filename, config->visit_threshold,
+                             config->out_format, config->threads);
+    else
+        save_strategy_file(hash_table, slices, filename, config->visit_threshold);
+}
+
+// Next multiple of every after done, capped at end (every == 0 means no boundary)
+static long next_boundary(long done, long every, long end)
+{
+    if (every <= 0) return end;
+    long b = (done / every + 1) * every;
+    return (b < end) ? b : end;
+}
+
+// Write a strategy snapshot from a forked child
+// - Called between segments, when no training threads exist; the monitor thread
+//   is paused across the fork so it holds no stdio or allocator locks there
+// - The child serializes its copy-on-write image of the table while the parent
+//   goes straight back to training; the stall is the fork itself
+static pid_t start_snapshot(Config *config, Monitor *monitor, Node **hash_table, int slices,
+                            long deals_done)
+{
+    char filename[4096];
+    snprintf(filename, sizeof(filename), "%s.%ld.bin", config->snapshot_prefix, deals_done);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    fflush(stdout);
+    monitor_pause(monitor);
+    pid_t pid = fork();
+    if (pid == 0) {
+        save_output(config, hash_table, slices, filename);
+        fflush(stdout);
+        PROF_FLUSH();
+        _exit(0);
+    }
+    monitor_resume(monitor);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    if (pid < 0)
+        fprintf(stderr, "Error: fork failed, snapshot %s skipped\n", filename);
+    else
+        printf("Snapshot at %ld deals -> %s (training stalled %.1f ms)\n", deals_done, filename,
+               (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+    return pid;
+}
+
+// Write a delta snapshot in this process, which owns the dirty flags it clears
+// - The first is a full base file <prefix>.<deals>.bin, later ones
+//   <prefix>.<deals>.delta.bin; both use the --out-format record type, sorted
+static void write_delta_snapshot(Config *config, DeltaRef *ref, Node **hash_table, int slices,
+                                 long deals_done)
+{
+    char filename[4096];
+    snprintf(filename, sizeof(filename), ref->started ? "%s.%ld.delta.bin" : "%s.%ld.bin",
+             config->snapshot_prefix, deals_done);
+
+    double t0 = now_seconds();
+    if (save_delta_snapshot(ref, hash_table, slices, filename, config->visit_threshold,
+                            config->out_format, config->threads) != 0)
+        fprintf(stderr, "Error: Delta snapshot %s failed\n", filename);
+    else
+        printf("Snapshot at %ld deals -> %s (training stalled %.1f ms)\n", deals_done, filename,
+               (now_seconds() - t0) * 1e3);
+}
+
+// Reap finished snapshot writers; with wait_all, block until every one has exited
+static void reap_snapshots(bool wait_all)
+{
+    int status;
+    while (waitpid(-1, &status, wait_all ? 0 : WNOHANG) > 0) {
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            fprintf(stderr, "Error: snapshot writer failed\n");
+    }
+}
+
+// Train deals [begin, end) on all threads, returning once every thread has joined
+// - Runs are split into segments at checkpoint boundaries so the table is quiescent
+//   while it is written
+// - Returns the end of the trained prefix, short of end if the deadline hit first;
+//   shards only check the deadline between segments, keeping the prefix exact
+static long run_segment(Config *config, ThreadData *thread_data, pthread_t *threads,
+                        long begin, long end)
+{
+    Scheduler sched;
+    atomic_init(&sched.next, (config->shards > 0) ? 0 : begin);
+    sched.end = (config->shards > 0) ? config->shards : end;
+    sched.batch = (config->shards > 0) ? 1 : DEAL_BATCH;
+    atomic_int active;
+    atomic_init(&active, config->threads);
+
+    for (int i = 0; i < config->threads; i++) {
+        thread_data[i].deal_begin = begin;
+        thread_data[i].deal_end = end;
+        thread_data[i].sched = &sched;
+        thread_data[i].active = &active;
+        pthread_create(&threads[i], NULL, train_thread, &thread_data[i]);
+    }
+
+    for (int i = 0; i < config->threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    if (config->shards > 0) return end;
+    long reached = atomic_load(&sched.next);
+    return (reached < end) ? reached : end;
+}
+
+// Multi-process training (see coord.h)
+// - Sync round r covers deals [r * sync_every, (r + 1) * sync_every); worker w trains
+//   the w-th contiguous part of it with the usual threads, then syncs with the parent
+// - The parent writes the output from the pooled table once every worker has finished
+static int run_procs(Config *config, ThreadData *thread_data, pthread_t *threads,
+                     Node **hash_table, int slices)
+{
+    int *fds = malloc(config->procs * sizeof(int));
+    pid_t *pids = malloc(config->procs * sizeof(pid_t));
+    fflush(stdout);
+
+    for (int w = 0; w < config->procs; w++) {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) {
+            fprintf(stderr, "Error: socketpair failed for worker %d\n", w);
+            return 1;
+        }
+        pids[w] = fork();
+        if (pids[w] < 0) {
+            fprintf(stderr, "Error: fork failed for worker %d\n", w);
+            return 1;
+        }
+        if (pids[w] == 0) {
+            close(sv[0]);
+            for (int k = 0; k < w; k++) close(fds[k]);
+
+            long deals = 0;
+            double sync_time = 0;
+            for (long start = 0; start < config->iterations; start += config->sync_every) {
+                long len = (start + config->sync_every < config->iterations) ?
+                           config->sync_every : config->iterations - start;
+                long lo = start + len * w / config->procs;
+                long hi = start + len * (w + 1) / config->procs;
+                if (hi > lo) run_segment(config, thread_data, threads, lo, hi);
+                deals += hi - lo;
+                double t0 = now_seconds();
+                if (coord_send_dirty(sv[1], hash_table, slices) != 0 ||
+                    coord_recv_updates(sv[1], hash_table, slices) != 0) {
+                    fprintf(stderr, "Error: Worker %d lost the coordinator\n", w);
+                    PROF_FLUSH();
+                    _exit(1);
+                }
+                sync_time += now_seconds() - t0;
+            }
+            printf("  Worker %d: %ld deals, %.2f seconds waiting on syncs\n", w, deals, sync_time);
+            fflush(stdout);
+            PROF_FLUSH();
+            _exit(0);
+        }
+        close(sv[1]);
+        fds[w] = sv[0];
+    }
+
+    // Coordinator: pooled values in one slice (the delta sums live in coord.c)
+    Node **shared = (Node **)calloc(NODE_QTY, sizeof(Node *));
+    if (!shared) {
+        fprintf(stderr, "Error: Cannot allocate pooled table\n");
+        return 1;
+    }
+    cfr_init_counts(1);
+
+    double start_time = now_seconds();
+    long rounds = 0, changed = 0;
+    int rc = 0;
+    for (long start = 0; start < config->iterations; start += config->sync_every) {
+        long n = coord_reduce(fds, config->procs, shared);
+        if (n < 0) {
+            rc = 1;
+            break;
+        }
+        changed += n;
+        rounds++;
+    }
+
+    for (int w = 0; w < config->procs; w++) {
+        close(fds[w]);
+        if (rc != 0) kill(pids[w], SIGTERM);
+    }
+    for (int w = 0; w < config->procs; w++) {
+        int status;
+        waitpid(pids[w], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) rc = 1;
+    }
+    free(fds);
+    free(pids);
+    if (rc != 0) {
+        fprintf(stderr, "Error: A worker failed; no output written\n");
+        return 1;
+    }
+
+    printf("Training completed in %.2f seconds\n", now_seconds() - start_time);
+    printf("Synced %ld rounds, %.0f nodes changed per round\n",
+           rounds, rounds ? (double)changed / rounds : 0.0);
+    printf("Saving strategy...\n");
+    save_output(config, shared, 1, config->output_file);
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
-    if (argc != 6) {
-        fprintf(stderr, "Usage: %s <threads> <iterations> <visit threshold> <output_file> <seed>\n", argv[0]);
+    stats_block_sigusr1();
+    Config config = {0};
+    config.warm_format = 'Q';
+    config.warm_weight = 100.0f;
+    config.out_format = 'S';
+    config.snapshot_delta = -1.0f;
+
+    static const struct option long_opts[] = {
+        { "split-depth", required_argument, NULL, 'd' },
+        { "shards",      required_argument, NULL, 's' },
+        { "checkpoint",  required_argument, NULL, 'c' },
+        { "checkpoint-every", required_argument, NULL, 'C' },
+        { "resume",      required_argument, NULL, 'r' },
+        { "snapshot-every",  required_argument, NULL, 'n' },
+        { "snapshot-prefix", required_argument, NULL, 'p' },
+        { "snapshot-delta",  required_argument, NULL, 'D' },
+        { "time-limit",  required_argument, NULL, 't' },
+        { "converge",    required_argument, NULL, 'e' },
+        { "sample-every", required_argument, NULL, 'a' },
+        { "trace",       required_argument, NULL, 'T' },
+        { "warm-start",  required_argument, NULL, 'w' },
+        { "warm-format", required_argument, NULL, 'f' },
+        { "warm-weight", required_argument, NULL, 'W' },
+        { "warm-regret", required_argument, NULL, 'R' },
+        { "max-mem",     required_argument, NULL, 'm' },
+        { "sorted",      no_argument,       NULL, 'o' },
+        { "out-format",  required_argument, NULL, 'O' },
+        { "procs",       required_argument, NULL, 'P' },
+        { "sync-every",  required_argument, NULL, 'y' },
+        { "stats-every", required_argument, NULL, 'i' },
+        { "stats-csv",   required_argument, NULL, 'I' },
+        { "hash-report", no_argument,       NULL, 'H' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 'd': config.split_depth = atoi(optarg); break;
+            case 's': config.shards = atoi(optarg); break;
+            case 'c': config.checkpoint_file = optarg; break;
+            case 'C': config.checkpoint_every = atol(optarg); break;
+            case 'r': config.resume_file = optarg; break;
+            case 'n': config.snapshot_every = atol(optarg); break;
+            case 'p': config.snapshot_prefix = optarg; break;
+            case 'D': config.snapshot_delta = atof(optarg); break;
+            case 't': config.time_limit = atof(optarg); break;
+            case 'e': config.converge_eps = atof(optarg); break;
+            case 'a': config.sample_every = atol(optarg); break;
+            case 'T': config.trace_file = optarg; break;
+            case 'w': config.warm_file = optarg; break;
+            case 'f': config.warm_format = optarg[0]; break;
+            case 'W': config.warm_weight = atof(optarg); break;
+            case 'R': config.warm_regret = atof(optarg); break;
+            case 'm': config.max_mem = atol(optarg); break;
+            case 'o': config.sorted = true; break;
+            case 'O': config.sorted = true; config.out_format = optarg[0]; break;
+            case 'P': config.procs = atoi(optarg); break;
+            case 'y': config.sync_every = atol(optarg); break;
+            case 'i': config.stats_every = atof(optarg); break;
+            case 'I': config.stats_csv = optarg; break;
+            case 'H': config.hash_report = true; break;
+            default:  usage(argv[0]); return 1;
+        }
+    }
+
+    if (argc - optind != 5) {
+        usage(argv[0]);
         return 1;
     }
     
-    Config config;
-    config.threads = atoi(argv[1]);
-    config.iterations = atoi(argv[2]);
-    config.visit_threshold = atoi(argv[3]);
-    config.output_file = argv[4];
-    config.base_seed = atoi(argv[5]);
+    char **pos = &argv[optind];
+    config.threads = atoi(pos[0]);
+    config.iterations = atoi(pos[1]);
+    config.visit_threshold = atoi(pos[2]);
+    config.output_file = pos[3];
+    config.base_seed = atoi(pos[4]);
     if (config.base_seed == 0) config.base_seed = (unsigned int)time(NULL);
+    if (!config.snapshot_prefix) config.snapshot_prefix = config.output_file;
+    bool sampling = (config.converge_eps > 0 || config.trace_file);
+    if (sampling && config.sample_every <= 0) config.sample_every = 1000;
+
+    if (config.out_format != 'S' && config.out_format != 's' &&
+        config.out_format != 'Q' && config.out_format != 'q') {
+        fprintf(stderr, "Error: Invalid output format '%c'. Use S or Q.\n", config.out_format);
+        return 1;
+    }
+    if (config.procs > 0) {
+        if (config.split_depth > 0 || config.shards > 0 || config.resume_file ||
+            config.warm_file || config.max_mem > 0 || config.checkpoint_file ||
+            config.snapshot_every > 0 || sampling || config.time_limit > 0 ||
+            config.stats_every > 0 || config.stats_csv) {
+            fprintf(stderr, "Error: --procs cannot be combined with --split-depth, --shards, "
+                            "--resume, --warm-start, --max-mem, checkpoints, snapshots, "
+                            "--time-limit, convergence sampling or telemetry\n");
+            return 1;
+        }
+        if (config.sync_every <= 0) config.sync_every = 100;
+    }
+    if (config.snapshot_delta >= 0 && config.snapshot_every <= 0) {
+        fprintf(stderr, "Error: --snapshot-delta needs --snapshot-every\n");
+        return 1;
+    }
+    if (config.max_mem > 0 && config.split_depth > 0) {
+        fprintf(stderr, "Error: --max-mem cannot be combined with --split-depth\n");
+        return 1;
+    }
+    if (config.warm_file && config.resume_file) {
+        fprintf(stderr, "Error: --warm-start and --resume cannot be combined\n");
+        return 1;
+    }
+    if (config.warm_format != 'S' && config.warm_format != 's' &&
+        config.warm_format != 'Q' && config.warm_format != 'q') {
+        fprintf(stderr, "Error: Invalid warm-start format '%c'. Use S or Q.\n", config.warm_format);
+        return 1;
+    }
+
+    if (config.shards > 0 && config.split_depth > 0) {
+        fprintf(stderr, "Error: --shards and --split-depth cannot be combined\n");
+        return 1;
+    }
     
     printf("=== CFR Training ===\n");
     printf("Threads: %d\n", config.threads);
@@ -122,9 +635,23 @@ int main(int argc, char *argv[])
     printf("Vist Thresholds: %d\n", config.visit_threshold);
     printf("Output: %s\n", config.output_file);
     printf("Base seed: %u\n", config.base_seed);
+    if (config.split_depth > 0)
+        printf("Split depth: %d (shared table slice)\n", config.split_depth);
+    if (config.shards > 0)
+        printf("Shards: %d (deterministic)\n", config.shards);
+    if (config.time_limit > 0)
+        printf("Time limit: %.0f seconds\n", config.time_limit);
+    if (config.converge_eps > 0)
+        printf("Converge below: %g (sampled every %ld deals)\n", config.converge_eps, config.sample_every);
+    if (config.procs > 0)
+        printf("Processes: %d (pooled, synced every %ld deals)\n", config.procs, config.sync_every);
     
     // Allocate hash table
-    long total_buckets = NODE_QTY * config.threads;
+    // - One private slice per thread, a single slice shared by all threads in split mode,
+    //   or one slice per shard in deterministic mode
+    int slices = (config.shards > 0) ? config.shards :
+                 (config.split_depth > 0) ? 1 : config.threads;
+    long total_buckets = (long)NODE_QTY * slices;
     Node **hash_table = (Node **)calloc(total_buckets, sizeof(Node *));
     if (!hash_table) {
         fprintf(stderr, "Error: Cannot allocate hash table\n");
@@ -132,40 +659,189 @@ int main(int argc, char *argv[])
     }
     
     printf("Hash table allocated: %ld buckets\n", total_buckets);
+    cfr_init_counts(slices);
+    if (config.snapshot_delta >= 0 || config.procs > 0)
+        cfr_track_dirty(slices);
+
+    // The bucket array comes out of the budget; the rest is split evenly across slices
+    long node_budget = 0;
+    if (config.max_mem > 0) {
+        long node_bytes = config.max_mem * 1024 * 1024 - total_buckets * (long)sizeof(Node *);
+        node_budget = node_bytes / (long)NODE_BYTES / slices;
+        if (node_budget <= 0) {
+            fprintf(stderr, "Error: --max-mem %ld MB does not cover the %ld MB bucket array\n",
+                    config.max_mem, total_buckets * (long)sizeof(Node *) >> 20);
+            return 1;
+        }
+        printf("Memory cap: %ld MB (%ld nodes per slice)\n", config.max_mem, node_budget);
+    }
+
+    if (config.split_depth > 0) {
+        cfr_set_shared(true);
+        pool_init();
+    }
+
+    if (config.warm_file &&
+        warm_start(config.warm_file, config.warm_format, config.warm_weight, config.warm_regret,
+                   hash_table, slices) < 0)
+        return 1;
+
+    // Restore training state; the deal streams continue from the checkpoint's seed
+    long deals_done = 0;
+    if (config.resume_file) {
+        CheckpointInfo info;
+        if (read_checkpoint(config.resume_file, hash_table, slices, &info) != 0)
+            return 1;
+        if (info.shards != config.shards) {
+            fprintf(stderr, "Error: Checkpoint was written with --shards %d, not %d\n",
+                    info.shards, config.shards);
+            return 1;
+        }
+        if (info.base_seed != config.base_seed)
+            printf("Using checkpoint base seed %u\n", info.base_seed);
+        config.base_seed = info.base_seed;
+        deals_done = info.deals_done;
+    }
     
     // Create threads
     pthread_t *threads = malloc(config.threads * sizeof(pthread_t));
     ThreadData *thread_data = malloc(config.threads * sizeof(ThreadData));
-    
-    int iterations_per_thread = config.iterations / config.threads;
-    
-    printf("Starting training...\n");
-    time_t start_time = time(NULL);
-    
+    ThreadCounters *counters = stats_alloc_counters(config.threads);
+    long *evict_rearm = calloc(slices, sizeof(long));
+    if (!counters || !evict_rearm) {
+        fprintf(stderr, "Error: Cannot allocate thread counters\n");
+        return 1;
+    }
+
     for (int i = 0; i < config.threads; i++) {
         thread_data[i].thread_id = i;
-        thread_data[i].iterations_per_thread = iterations_per_thread;
+        thread_data[i].slice = (config.split_depth > 0) ? 0 : i;
+        thread_data[i].split_depth = config.split_depth;
+        thread_data[i].shards = config.shards;
         thread_data[i].hash_table = hash_table;
-        thread_data[i].seed = config.base_seed + (i * 10000);
-        
-        pthread_create(&threads[i], NULL, train_thread, &thread_data[i]);
+        thread_data[i].base_seed = config.base_seed;
+        thread_data[i].deals_done = 0;
+        thread_data[i].node_budget = node_budget;
+        thread_data[i].evicted = 0;
+        thread_data[i].evict_cutoff = 0;
+        thread_data[i].evict_rearm = evict_rearm;
+        thread_data[i].counters = &counters[i];
     }
     
-    // Wait for threads
-    for (int i = 0; i < config.threads; i++) {
-        pthread_join(threads[i], NULL);
+    FILE *trace_fp = NULL;
+    if (config.trace_file) {
+        trace_fp = fopen(config.trace_file, "a");
+        if (!trace_fp) {
+            fprintf(stderr, "Error: Cannot open trace file %s\n", config.trace_file);
+            return 1;
+        }
+        if (ftell(trace_fp) == 0)
+            fprintf(trace_fp, "deals,seconds,nodes,bid_regret,play_regret\n");
     }
+
+    printf("Starting training...\n");
+    double start_time = now_seconds();
+    double deadline = (config.time_limit > 0) ? start_time + config.time_limit : 0;
+    for (int i = 0; i < config.threads; i++)
+        thread_data[i].deadline = deadline;
+    if (config.procs > 0)
+        return run_procs(&config, thread_data, threads, hash_table, slices);
+    Monitor monitor;
+    if (monitor_start(&monitor, counters, config.threads, slices, config.stats_every,
+                      config.stats_csv) != 0)
+        return 1;
+    const char *stop_reason = NULL;
+    bool checkpoint_failed = false;
+    DeltaRef delta_ref = { NULL, 0, config.snapshot_delta, false };
+
+    // Train in segments ending at each checkpoint, snapshot or sample boundary
+    while (deals_done < config.iterations && !stop_reason) {
+        long seg_end = next_boundary(deals_done, config.checkpoint_every, config.iterations);
+        long snap_end = next_boundary(deals_done, config.snapshot_every, config.iterations);
+        long sample_end = next_boundary(deals_done, config.sample_every, config.iterations);
+        if (snap_end < seg_end) seg_end = snap_end;
+        if (sample_end < seg_end) seg_end = sample_end;
+        if (config.shards > 0 && deadline > 0) {
+            long time_end = next_boundary(deals_done, (long)config.shards * SHARD_TIME_DEALS,
+                                          config.iterations);
+            if (time_end < seg_end) seg_end = time_end;
+        }
+
+        long reached = run_segment(&config, thread_data, threads, deals_done, seg_end);
+        bool at_boundary = (reached == seg_end);
+        deals_done = reached;
+        if (deadline > 0 && now_seconds() >= deadline)
+            stop_reason = "time limit";
+
+        if (sampling && (stop_reason || deals_done % config.sample_every == 0 ||
+                         deals_done == config.iterations)) {
+            RegretSample rs;
+            sample_regret(hash_table, slices, &rs);
+            double elapsed = now_seconds() - start_time;
+            if (trace_fp) {
+                fprintf(trace_fp, "%ld,%.3f,%ld,%.6f,%.6f\n", deals_done, elapsed, rs.nodes,
+                        rs.regret[BID], rs.regret[PLAY]);
+                fflush(trace_fp);
+            }
+            printf("  %ld deals, %.1fs: %ld nodes, avg regret bid %.4f play %.4f\n", deals_done,
+                   elapsed, rs.nodes, rs.regret[BID], rs.regret[PLAY]);
+            if (config.converge_eps > 0 && !stop_reason &&
+                rs.regret[BID] < config.converge_eps && rs.regret[PLAY] < config.converge_eps)
+                stop_reason = "converged";
+        }
+
+        if (config.checkpoint_file &&
+            (stop_reason || deals_done == config.iterations ||
+             (config.checkpoint_every > 0 && deals_done % config.checkpoint_every == 0))) {
+            CheckpointInfo info = { config.base_seed, config.shards, deals_done };
+            checkpoint_failed =
+                write_checkpoint(config.checkpoint_file, hash_table, slices, &info) != 0;
+            if (checkpoint_failed)
+                fprintf(stderr, "Error: Checkpoint at %ld deals not saved; %s keeps the previous one\n",
+                        deals_done, config.checkpoint_file);
+        }
+
+        reap_snapshots(false);
+        if (config.snapshot_every > 0 && at_boundary && deals_done % config.snapshot_every == 0 &&
+            deals_done < config.iterations && !stop_reason) {
+            if (config.snapshot_delta >= 0)
+                write_delta_snapshot(&config, &delta_ref, hash_table, slices, deals_done);
+            else
+                start_snapshot(&config, &monitor, hash_table, slices, deals_done);
+        }
+    }
+    free_delta_ref(&delta_ref);
+    reap_snapshots(true);
+    monitor_stop(&monitor);
+    if (trace_fp) fclose(trace_fp);
     
-    time_t end_time = time(NULL);
-    printf("Training completed in %ld seconds\n", end_time - start_time);
+    double end_time = now_seconds();
+    if (stop_reason)
+        printf("Stopped early (%s) after %ld of %d deals\n", stop_reason, deals_done, config.iterations);
+    printf("Training completed in %.2f seconds\n", end_time - start_time);
+    for (int i = 0; i < config.threads; i++)
+        printf("  Thread %d: %ld deals\n", i, thread_data[i].deals_done);
+    if (node_budget > 0) {
+        long evicted = 0;
+        int cutoff = 0;
+        for (int i = 0; i < config.threads; i++) {
+            evicted += thread_data[i].evicted;
+            if (thread_data[i].evict_cutoff > cutoff) cutoff = thread_data[i].evict_cutoff;
+        }
+        printf("Evicted %ld nodes (visit cutoff up to %d)\n", evicted, cutoff);
+    }
     
+    if (config.hash_report)
+        hash_report(hash_table, slices);
+
     // Save strategy
     printf("Saving strategy...\n");
-    save_strategy_file(hash_table, config.threads, config.output_file, config.visit_threshold);
+    save_output(&config, hash_table, slices, config.output_file);
     
     // Cleanup
     free(threads);
     free(thread_data);
+    free(counters);
     
     // Free hash table nodes
     for (long i = 0; i < total_buckets; i++) {
@@ -178,6 +854,10 @@ int main(int argc, char *argv[])
     }
     free(hash_table);
     
+    if (checkpoint_failed) {
+        fprintf(stderr, "Error: The last checkpoint failed, so %s is out of date\n", config.checkpoint_file);
+        return 1;
+    }
     printf("Done!\n");
     return 0;
 }
@@ -0,0 +1,473 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include <pthread.h>
+#include "output.h"
+#include "cfr.h"
+#include "strategy.h"
+#include "key.h"
+
+// Records buffered per fwrite
+#define OUT_CHUNK 65536
+// Records insertion-sorted together before the merge passes of sort_run
+#define SORT_BLOCK 32
+
+// One sort or merge job over a run of records
+typedef struct {
+    Strat *src;
+    Strat *dst;
+    long lo, mid, hi;   // Sort [lo, hi) using dst as scratch, or merge [lo, mid) and [mid, hi) from src into dst
+} SortJob;
+
+// Merge [lo, mid) and [mid, hi) of src into dst
+// - Ties take the left side first, so the merge is stable
+static void merge_range(const Strat *src, Strat *dst, long lo, long mid, long hi)
+{
+    long i = lo, j = mid, k = lo;
+    while (i < mid && j < hi) {
+        if (compare_keys(&src[j], &src[i]) < 0)
+            dst[k++] = src[j++];
+        else
+            dst[k++] = src[i++];
+    }
+    while (i < mid) dst[k++] = src[i++];
+    while (j < hi) dst[k++] = src[j++];
+}
+
+// Stable sort of one run: insertion sort SORT_BLOCK records at a time, then merge
+// passes between src and dst; the result ends in src
+// - Stability keeps duplicate keys in gather (slice) order, so gather_sorted averages
+//   them in the same order whatever the thread count (qsort is not stable)
+static void *sort_run(void *arg)
+{
+    SortJob *job = (SortJob *)arg;
+    Strat *a = job->src, *b = job->dst;
+    for (long lo = job->lo; lo < job->hi; lo += SORT_BLOCK) {
+        long hi = (lo + SORT_BLOCK < job->hi) ? lo + SORT_BLOCK : job->hi;
+        for (long i = lo + 1; i < hi; i++) {
+            Strat cur = a[i];
+            long j = i;
+            for (; j > lo && compare_keys(&cur, &a[j - 1]) < 0; j--)
+                a[j] = a[j - 1];
+            a[j] = cur;
+        }
+    }
+    for (long width = SORT_BLOCK; width < job->hi - job->lo; width *= 2) {
+        for (long lo = job->lo; lo < job->hi; lo += 2 * width) {
+            long mid = (lo + width < job->hi) ? lo + width : job->hi;
+            long hi = (lo + 2 * width < job->hi) ? lo + 2 * width : job->hi;
+            merge_range(a, b, lo, mid, hi);
+        }
+        Strat *swap = a; a = b; b = swap;
+    }
+    if (a != job->src)
+        memcpy(job->src + job->lo, a + job->lo, (job->hi - job->lo) * sizeof(Strat));
+    return NULL;
+}
+
+static void *merge_runs(void *arg)
+{
+    SortJob *job = (SortJob *)arg;
+    merge_range(job->src, job->dst, job->lo, job->mid, job->hi);
+    return NULL;
+}
+
+// Stable sort of n records: sort one run per thread, then merge pairs of runs level
+// by level; ties take the left run first, so equal records keep gather order
+// - Returns whichever of buf/tmp holds the sorted result
+static Strat *parallel_sort(Strat *buf, Strat *tmp, long n, int threads)
+{
+    int runs = (threads < 1) ? 1 : threads;
+    if (runs > n) runs = (n > 0) ? (int)n : 1;
+
+    long *bound = malloc((runs + 1) * sizeof(long));
+    pthread_t *tid = malloc(runs * sizeof(pthread_t));
+    SortJob *jobs = malloc(runs * sizeof(SortJob));
+    for (int r = 0; r <= runs; r++)
+        bound[r] = n * r / runs;
+
+    for (int r = 0; r < runs; r++) {
+        jobs[r] = (SortJob){ buf, tmp, bound[r], bound[r], bound[r + 1] };
+        pthread_create(&tid[r], NULL, sort_run, &jobs[r]);
+    }
+    for (int r = 0; r < runs; r++)
+        pthread_join(tid[r], NULL);
+
+    // Each level merges runs (r, r + width) into the other buffer; an unpaired last
+    // run is merged with an empty neighbour, which just copies it across
+    for (int width = 1; width < runs; width *= 2) {
+        int jn = 0;
+        for (int r = 0; r < runs; r += 2 * width) {
+            int m = (r + width < runs) ? r + width : runs;
+            int h = (r + 2 * width < runs) ? r + 2 * width : runs;
+            jobs[jn] = (SortJob){ buf, tmp, bound[r], bound[m], bound[h] };
+            pthread_create(&tid[jn], NULL, merge_runs, &jobs[jn]);
+            jn++;
+        }
+        for (int j = 0; j < jn; j++)
+            pthread_join(tid[j], NULL);
+        Strat *swap = buf; buf = tmp; tmp = swap;
+    }
+
+    free(bound);
+    free(tid);
+    free(jobs);
+    return buf;
+}
+
+// A node's average strategy as a Strat record
+static void node_record(const Node *cur, Strat *st)
+{
+    memset(st, 0, sizeof(Strat));
+    memcpy(st->bits, cur->key.bits, KEY_BYTES);
+    st->action_count = cur->action_count;
+    memcpy(st->action, cur->action, MAX_ACTIONS);
+    st->mask = cur->mask;
+    node_average(cur, st->strategy);
+}
+
+// Average count duplicate records of one information set into st, summing in the
+// order given (slice order), so the float rounding does not depend on the thread count
+static void average_duplicates(Strat *st, const Strat *dup, long count)
+{
+    *st = dup[0];
+    if (count < 2) return;
+    for (int a = 0; a < st->action_count; a++) {
+        float sum = 0.0f;
+        for (long d = 0; d < count; d++)
+            sum += dup[d].strategy[a];
+        st->strategy[a] = sum / (float)count;
+    }
+}
+
+// Gather every slice's nodes with at least visit_threshold visits in slice order, sort
+// them stably and average duplicate keys in place, as kwayp does across files
+// - Returns the number of records left in *sorted (which points into *buf or *tmp;
+//   the caller frees both), or -1 if the buffers cannot be allocated
+static long gather_sorted(Node **hash_table, int slices, int visit_threshold, int threads,
+                          Strat **buf, Strat **tmp, Strat **sorted, long *too_few_visits,
+                          long *duplicates)
+{
+    long total_buckets = (long)NODE_QTY * slices;
+    long count = 0;
+    *too_few_visits = 0;
+    for (long i = 0; i < total_buckets; i++) {
+        for (Node *cur = hash_table[i]; cur; cur = cur->next) {
+            if (cur->visits < visit_threshold) (*too_few_visits)++;
+            else count++;
+        }
+    }
+
+    *buf = malloc((count ? count : 1) * sizeof(Strat));
+    *tmp = malloc((count ? count : 1) * sizeof(Strat));
+    if (!*buf || !*tmp) {
+        fprintf(stderr, "Error: Cannot allocate %ld nodes for sorted output\n", count);
+        free(*buf);
+        free(*tmp);
+        *buf = *tmp = NULL;
+        return -1;
+    }
+
+    long n = 0;
+    for (long i = 0; i < total_buckets; i++) {
+        for (Node *cur = hash_table[i]; cur; cur = cur->next) {
+            if (cur->visits < visit_threshold) continue;
+            node_record(cur, &(*buf)[n++]);
+        }
+    }
+
+    Strat *s = parallel_sort(*buf, *tmp, count, threads);
+    *sorted = s;
+
+    long out = 0;
+    for (long i = 0; i < count; ) {
+        long j = i + 1;
+        while (j < count && compare_keys(&s[i], &s[j]) == 0) j++;
+        average_duplicates(&s[out], &s[i], j - i);
+        out++;
+        i = j;
+    }
+    *duplicates = count - out;
+    return out;
+}
+
+// Write n sorted records as Strat ('S') or quantized Strat_255 ('Q')
+static int write_records(const char *filename, Strat *recs, long n, char format)
+{
+    int rc = 0;
+    FILE *fp = fopen(filename, "wb");
+    if (!fp) {
+        fprintf(stderr, "Error: Cannot open output file %s\n", filename);
+        return -1;
+    }
+    if (format == 'Q' || format == 'q') {
+        Strat_255 *q = malloc(OUT_CHUNK * sizeof(Strat_255));
+        for (long i = 0; i < n && rc == 0; i += OUT_CHUNK) {
+            long len = (n - i < OUT_CHUNK) ? n - i : OUT_CHUNK;
+            for (long k = 0; k < len; k++)
+                quantize_output(&recs[i + k], &q[k], recs[i + k].action_count);
+            if (fwrite(q, sizeof(Strat_255), len, fp) != (size_t)len) rc = -1;
+        }
+        free(q);
+    } else {
+        if (fwrite(recs, sizeof(Strat), n, fp) != (size_t)n) rc = -1;
+    }
+    if (fclose(fp) != 0) rc = -1;
+    if (rc != 0) fprintf(stderr, "Error: Write failed on output file %s\n", filename);
+    return rc;
+}
+
+int save_sorted_strategy(Node **hash_table, int slices, const char *filename,
+                         int visit_threshold, char format, int threads)
+{
+    Strat *buf, *tmp, *sorted;
+    long too_few_visits, duplicates;
+    long out = gather_sorted(hash_table, slices, visit_threshold, threads,
+                             &buf, &tmp, &sorted, &too_few_visits, &duplicates);
+    if (out < 0) return -1;
+
+    int rc = write_records(filename, sorted, out, format);
+    free(buf);
+    free(tmp);
+    if (rc != 0) return -1;
+
+    printf("Pruned %ld nodes for being visited less than %d times\n", too_few_visits, visit_threshold);
+    printf("Saved %ld sorted nodes (%ld duplicates averaged) to %s as %s\n", out, duplicates,
+           filename, (format == 'Q' || format == 'q') ? "Strat_255" : "Strat");
+    return 0;
+}
+
+// Key-then-mask order between a reference record and a gathered one (compare_keys order)
+static int compare_ref(const Strat_255 *r, const Strat *s)
+{
+    Key kr = key_from_bits(r->bits), ks = key_from_bits(s->bits);
+    int c = key_cmp(&kr, &ks);
+    if (c != 0) return c;
+    return (int)r->mask - (int)s->mask;
+}
+
+// Largest per-action move between two quantized strategies, in units of 1/255
+static int max_move(const Strat_255 *a, const Strat_255 *b)
+{
+    int m = 0;
+    for (int i = 0; i < a->action_count; i++) {
+        int d = abs((int)a->s255[i] - (int)b->s255[i]);
+        if (d > m) m = d;
+    }
+    return m;
+}
+
+static int compare_dirty(const void *a, const void *b)
+{
+    const DirtyKey *x = (const DirtyKey *)a, *y = (const DirtyKey *)b;
+    int c = key_cmp(&x->key, &y->key);
+    if (c != 0) return c;
+    return (int)x->mask - (int)y->mask;
+}
+
+// Take every slice's dirty list into one sorted array without repeats
+// - Returns the number of information sets in *out (caller frees), or -1 if they
+//   cannot be allocated
+static long take_changed(int slices, DirtyKey **out)
+{
+    DirtyKey **lists = malloc(slices * sizeof(DirtyKey *));
+    long *counts = malloc(slices * sizeof(long));
+    long total = 0;
+    for (int s = 0; lists && counts && s < slices; s++) {
+        counts[s] = cfr_take_dirty(s, &lists[s]);
+        total += counts[s];
+    }
+    *out = (lists && counts) ? malloc((total ? total : 1) * sizeof(DirtyKey)) : NULL;
+    long n = -1;
+    if (!*out) {
+        fprintf(stderr, "Error: Cannot allocate %ld nodes for the delta snapshot\n", total);
+    } else {
+        n = 0;
+        for (int s = 0; s < slices; s++) {
+            memcpy(*out + n, lists[s], counts[s] * sizeof(DirtyKey));
+            n += counts[s];
+        }
+        qsort(*out, n, sizeof(DirtyKey), compare_dirty);
+        long u = 0;
+        for (long i = 0; i < n; i++)
+            if (u == 0 || compare_dirty(&(*out)[u - 1], &(*out)[i]) != 0)
+                (*out)[u++] = (*out)[i];
+        n = u;
+    }
+    for (int s = 0; lists && counts && s < slices; s++)
+        free(lists[s]);
+    free(lists);
+    free(counts);
+    return n;
+}
+
+// Clear the dirty flag of an information set's nodes and average the ones with at
+// least visit_threshold visits into st, in slice order with average_duplicates as
+// gather_sorted does; dup has room for one record per slice
+// - Returns false if no slice holds it with enough visits
+static bool combine_slices(Node **hash_table, int slices, const DirtyKey *c,
+                           int visit_threshold, Strat *dup, Strat *st)
+{
+    long found = 0;
+    for (int s = 0; s < slices; s++) {
+        Node *cur = lookup_node(hash_table, &c->key, c->mask, s);
+        if (!cur) continue;
+        cur->dirty = 0;
+        if (cur->visits >= visit_threshold)
+            node_record(cur, &dup[found++]);
+    }
+    if (found > 0) average_duplicates(st, dup, found);
+    return found > 0;
+}
+
+// Position of s in the sorted reference, or -1 if it has no entry
+static long find_ref(const DeltaRef *ref, const Strat *s)
+{
+    long lo = 0, hi = ref->count;
+    while (lo < hi) {
+        long mid = lo + (hi - lo) / 2;
+        int c = compare_ref(&ref->ref[mid], s);
+        if (c == 0) return mid;
+        if (c < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return -1;
+}
+
+// First snapshot: a full sorted file, which becomes the reference when eps > 0
+static int save_delta_base(DeltaRef *ref, Node **hash_table, int slices, const char *filename,
+                           int visit_threshold, char format, int threads)
+{
+    Strat *buf, *tmp, *sorted;
+    long too_few_visits, duplicates;
+    long n = gather_sorted(hash_table, slices, visit_threshold, threads,
+                           &buf, &tmp, &sorted, &too_few_visits, &duplicates);
+    if (n < 0) return -1;
+
+    if (ref->eps > 0) {
+        ref->ref = malloc((n ? n : 1) * sizeof(Strat_255));
+        if (!ref->ref) {
+            fprintf(stderr, "Error: Cannot allocate %ld nodes for the delta reference\n", n);
+            free(buf);
+            free(tmp);
+            return -1;
+        }
+        for (long i = 0; i < n; i++)
+            quantize_output(&sorted[i], &ref->ref[i], sorted[i].action_count);
+        ref->count = n;
+    }
+    int rc = write_records(filename, sorted, n, format);
+    free(buf);
+    free(tmp);
+    if (rc != 0) {
+        free_delta_ref(ref);
+        return -1;
+    }
+
+    // Later deltas start from here: clear every flag and drop the lists so far
+    long total_buckets = (long)NODE_QTY * slices;
+    for (long i = 0; i < total_buckets; i++)
+        for (Node *cur = hash_table[i]; cur; cur = cur->next)
+            cur->dirty = 0;
+    for (int s = 0; s < slices; s++) {
+        DirtyKey *keys;
+        cfr_take_dirty(s, &keys);
+        free(keys);
+    }
+    ref->started = true;
+
+    printf("Delta base: %ld sorted nodes (%ld duplicates averaged) written to %s\n",
+           n, duplicates, filename);
+    return 0;
+}
+
+int save_delta_snapshot(DeltaRef *ref, Node **hash_table, int slices, const char *filename,
+                        int visit_threshold, char format, int threads)
+{
+    if (!ref->started)
+        return save_delta_base(ref, hash_table, slices, filename, visit_threshold, format, threads);
+
+    DirtyKey *changed;
+    long n = take_changed(slices, &changed);
+    if (n < 0) return -1;
+
+    // Records that are new or moved are written; with eps > 0 moved ones replace their
+    // reference entry in place and new ones are merged into the reference afterwards
+    Strat *recs = malloc((n ? n : 1) * sizeof(Strat));
+    Strat *dup = malloc(slices * sizeof(Strat));
+    Strat_255 *fresh = (ref->eps > 0) ? malloc((n ? n : 1) * sizeof(Strat_255)) : NULL;
+    if (!recs || !dup || (ref->eps > 0 && !fresh)) {
+        fprintf(stderr, "Error: Cannot allocate %ld nodes for the delta snapshot\n", n);
+        free(changed);
+        free(recs);
+        free(dup);
+        free(fresh);
+        return -1;
+    }
+    int limit = (int)(ref->eps * 255.0f);
+    long out = 0, nfresh = 0, moved = 0, visited = 0;
+    for (long i = 0; i < n; i++) {
+        Strat *st = &recs[out];
+        if (!combine_slices(hash_table, slices, &changed[i], visit_threshold, dup, st)) continue;
+        visited++;
+        if (ref->eps <= 0) {
+            out++;
+            continue;
+        }
+        Strat_255 q;
+        quantize_output(st, &q, st->action_count);
+        long r = find_ref(ref, st);
+        if (r < 0) {
+            fresh[nfresh++] = q;
+            out++;
+        } else if (max_move(&q, &ref->ref[r]) > limit) {
+            ref->ref[r] = q;
+            moved++;
+            out++;
+        }
+    }
+    free(changed);
+    free(dup);
+
+    int rc = write_records(filename, recs, out, format);
+    free(recs);
+    if (rc == 0 && nfresh > 0) {
+        Strat_255 *next = malloc((ref->count + nfresh) * sizeof(Strat_255));
+        if (!next) {
+            fprintf(stderr, "Error: Cannot allocate %ld nodes for the delta reference\n",
+                    ref->count + nfresh);
+            rc = -1;
+        } else {
+            long i = 0, j = 0, k = 0;
+            while (i < ref->count || j < nfresh) {
+                Strat f;
+                if (j < nfresh) {
+                    memcpy(f.bits, fresh[j].bits, KEY_BYTES);
+                    f.mask = fresh[j].mask;
+                }
+                if (j == nfresh || (i < ref->count && compare_ref(&ref->ref[i], &f) < 0))
+                    next[k++] = ref->ref[i++];
+                else
+                    next[k++] = fresh[j++];
+            }
+            free(ref->ref);
+            ref->ref = next;
+            ref->count = k;
+        }
+    }
+    free(fresh);
+    if (rc != 0) return -1;
+
+    if (ref->eps > 0)
+        printf("Delta: %ld of %ld changed nodes written to %s (%ld new, %ld moved more than %g)\n",
+               out, visited, filename, nfresh, moved, ref->eps);
+    else
+        printf("Delta: %ld changed nodes written to %s\n", out, filename);
+    return 0;
+}
+
+void free_delta_ref(DeltaRef *ref)
+{
+    free(ref->ref);
+    ref->ref = NULL;
+    ref->count = 0;
+}
@@ -0,0 +1,40 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include "types.h"
+
+// Sorted strategy output (--sorted, --out-format)
+// - Gathers every slice's nodes with at least visit_threshold visits, sorts them by
+//   key on `threads` threads and averages duplicates across slices the way ct-kwayp
+//   does, so each information set is written once, in ct-kwayp order
+// - format 'S' writes Strat records ct-kwayp can merge without re-sorting,
+//   'Q' writes quantized Strat_255 records ct-playa can load directly
+// - Returns 0 on success, -1 on error
+int save_sorted_strategy(Node **hash_table, int slices, const char *filename,
+                         int visit_threshold, char format, int threads);
+
+// Delta snapshots (--snapshot-delta)
+// - The first call writes a full sorted base file and clears every node's dirty flag
+// - Later calls visit only the information sets with a node updated since the previous
+//   call (dirty), combine them across slices and write, in sorted order and the given
+//   format, the ones that are new or whose quantized average moved by more than eps
+//   (max over actions) since the snapshot that last wrote them; ct-compact folds a
+//   base and its deltas back into a full file
+// - With eps > 0, ref holds the last written Strat_255 value of every information
+//   set; with eps = 0 no reference is kept and every changed information set is written
+// - Information sets that disappear (evicted, or below visit_threshold) are not
+//   written; compaction keeps their last written value
+typedef struct {
+    Strat_255 *ref;     // Sorted by key, then mask (eps > 0 only)
+    long count;
+    float eps;
+    bool started;       // Base file written
+} DeltaRef;
+
+int save_delta_snapshot(DeltaRef *ref, Node **hash_table, int slices, const char *filename,
+                        int visit_threshold, char format, int threads);
+void free_delta_ref(DeltaRef *ref);
+
+#endif // OUTPUT_H
@@ -0,0 +1,72 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include "pool.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stddef.h>
+
+// Single LIFO queue; tasks are coarse (whole subtrees) so one lock is enough
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static Task *queue_head = NULL;
+static atomic_int queue_len;
+
+void pool_init(void)
+{
+    queue_head = NULL;
+    atomic_init(&queue_len, 0);
+}
+
+void pool_group_init(TaskGroup *g)
+{
+    atomic_init(&g->pending, 0);
+}
+
+// Queue a task for any thread to run
+void pool_spawn(TaskGroup *g, Task *t)
+{
+    t->group = g;
+    atomic_fetch_add_explicit(&g->pending, 1, memory_order_relaxed);
+
+    pthread_mutex_lock(&queue_lock);
+    t->next = queue_head;
+    queue_head = t;
+    atomic_fetch_add_explicit(&queue_len, 1, memory_order_release);
+    pthread_mutex_unlock(&queue_lock);
+}
+
+// Pop and run one queued task; returns 0 if the queue was empty
+static int run_one(void)
+{
+    if (atomic_load_explicit(&queue_len, memory_order_acquire) == 0) return 0;
+
+    pthread_mutex_lock(&queue_lock);
+    Task *t = queue_head;
+    if (t) {
+        queue_head = t->next;
+        atomic_fetch_sub_explicit(&queue_len, 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&queue_lock);
+    if (!t) return 0;
+
+    TaskGroup *g = t->group;
+    t->fn(t);
+    atomic_fetch_sub_explicit(&g->pending, 1, memory_order_release);
+    return 1;
+}
+
+// Wait for every task in the group, running queued work meanwhile
+void pool_wait(TaskGroup *g)
+{
+    while (atomic_load_explicit(&g->pending, memory_order_acquire) > 0) {
+        if (!run_one()) sched_yield();
+    }
+}
+
+// Run queued work until the active counter drops to zero
+// - Used by threads that have no deals left while others are still training
+void pool_help(atomic_int *active)
+{
+    while (atomic_load_explicit(active, memory_order_acquire) > 0) {
+        if (!run_one()) sched_yield();
+    }
+}
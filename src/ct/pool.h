@@ -0,0 +1,32 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdatomic.h>
+
+// Fork-join task pool shared by the training threads
+// - There are no dedicated workers: a thread waiting on its children, or one
+//   that has run out of deals, pops and runs queued tasks from other threads
+// - Tasks are owned by the spawner (typically on its stack) and must stay live
+//   until pool_wait returns for their group
+
+// Completion counter for a set of sibling tasks
+typedef struct {
+    atomic_int pending;
+} TaskGroup;
+
+// Queued unit of work; embed as the first member of a larger task struct
+typedef struct Task {
+    void (*fn)(struct Task *t);
+    TaskGroup *group;
+    struct Task *next;
+} Task;
+
+void pool_init(void);
+void pool_group_init(TaskGroup *g);
+void pool_spawn(TaskGroup *g, Task *t);
+void pool_wait(TaskGroup *g);
+void pool_help(atomic_int *active);
+
+#endif // POOL_H
@@ -0,0 +1,167 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include <signal.h>
+#include <time.h>
+#include "stats.h"
+#include "cfr.h"
+
+void stats_block_sigusr1(void)
+{
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+}
+
+static double monitor_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+ThreadCounters *stats_alloc_counters(int threads)
+{
+    ThreadCounters *c = aligned_alloc(_Alignof(ThreadCounters), threads * sizeof(ThreadCounters));
+    if (!c) return NULL;
+    for (int i = 0; i < threads; i++) {
+        atomic_init(&c[i].deals, 0);
+        atomic_init(&c[i].visits, 0);
+    }
+    return c;
+}
+
+// One report line to stderr (and a CSV row)
+// - Rates cover the time since the previous report; a thread whose visit count has
+//   not moved since then is flagged idle (between segments, out of deals, or stalled)
+static void report(Monitor *m, const char *why)
+{
+    double now = monitor_now();
+    double dt = now - m->last_time;
+    long deals = 0, visits = 0, nodes = 0, buckets = 0;
+    for (int i = 0; i < m->threads; i++) {
+        deals += atomic_load_explicit(&m->counters[i].deals, memory_order_relaxed);
+        visits += atomic_load_explicit(&m->counters[i].visits, memory_order_relaxed);
+    }
+    for (int t = 0; t < m->slices; t++) {
+        nodes += cfr_slice_nodes(t);
+        buckets += cfr_slice_buckets(t);
+    }
+    double deal_rate = (dt > 0) ? (deals - m->last_deals) / dt : 0;
+    double visit_rate = (dt > 0) ? (visits - m->last_visits) / dt : 0;
+    long bytes = nodes * (long)NODE_BYTES + m->total_buckets * (long)sizeof(Node *);
+    double chain = (buckets > 0) ? (double)nodes / buckets : 0;
+
+    fprintf(stderr, "[stats%s] %.1fs deals %ld (%.1f/s) visits %.0f/s nodes %ld mem %.1f MB chain %.2f |",
+            why, now - m->start, deals, deal_rate, visit_rate, nodes, bytes / 1048576.0, chain);
+    for (int i = 0; i < m->threads; i++) {
+        long td = atomic_load_explicit(&m->counters[i].deals, memory_order_relaxed);
+        long tv = atomic_load_explicit(&m->counters[i].visits, memory_order_relaxed);
+        fprintf(stderr, " t%d %ld%s", i, td, (tv == m->last_thread_visits[i]) ? " idle" : "");
+        m->last_thread_visits[i] = tv;
+    }
+    fprintf(stderr, "\n");
+
+    if (m->csv) {
+        fprintf(m->csv, "%.3f,%ld,%.2f,%.0f,%ld,%ld,%.4f", now - m->start, deals, deal_rate,
+                visit_rate, nodes, bytes, chain);
+        for (int i = 0; i < m->threads; i++)
+            fprintf(m->csv, ",%ld", atomic_load_explicit(&m->counters[i].deals, memory_order_relaxed));
+        fprintf(m->csv, "\n");
+        fflush(m->csv);
+    }
+
+    m->last_time = now;
+    m->last_deals = deals;
+    m->last_visits = visits;
+}
+
+// Sleep in sigtimedwait until the next report is due or SIGUSR1 arrives (blocked in
+// every thread, see stats_block_sigusr1); monitor_stop wakes it with SIGUSR1 too
+static void *monitor_thread(void *arg)
+{
+    Monitor *m = (Monitor *)arg;
+    double next = (m->interval > 0) ? m->start + m->interval : 0;
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGUSR1);
+
+    while (!atomic_load(&m->stop)) {
+        int sig;
+        if (next > 0) {
+            double wait = next - monitor_now();
+            if (wait < 0) wait = 0;
+            struct timespec ts = { (time_t)wait, (long)((wait - (time_t)wait) * 1e9) };
+            sig = sigtimedwait(&set, NULL, &ts);
+        } else {
+            sig = sigwaitinfo(&set, NULL);
+        }
+        if (atomic_load(&m->stop)) break;
+        pthread_mutex_lock(&m->lock);
+        if (sig == SIGUSR1)
+            report(m, " SIGUSR1");
+        if (next > 0 && monitor_now() >= next) {
+            report(m, "");
+            next += m->interval;
+        }
+        pthread_mutex_unlock(&m->lock);
+    }
+    return NULL;
+}
+
+int monitor_start(Monitor *m, ThreadCounters *counters, int threads, int slices,
+                  double interval, const char *csv_file)
+{
+    memset(m, 0, sizeof(*m));
+    m->counters = counters;
+    m->threads = threads;
+    m->slices = slices;
+    m->total_buckets = (long)NODE_QTY * slices;
+    m->interval = interval;
+    m->start = m->last_time = monitor_now();
+    m->last_thread_visits = calloc(threads, sizeof(long));
+    atomic_init(&m->stop, false);
+    pthread_mutex_init(&m->lock, NULL);
+
+    if (csv_file) {
+        m->csv = fopen(csv_file, "a");
+        if (!m->csv) {
+            fprintf(stderr, "Error: Cannot open stats file %s\n", csv_file);
+            return -1;
+        }
+        if (ftell(m->csv) == 0) {
+            fprintf(m->csv, "seconds,deals,deals_per_sec,visits_per_sec,nodes,bytes,avg_chain");
+            for (int i = 0; i < threads; i++)
+                fprintf(m->csv, ",t%d_deals", i);
+            fprintf(m->csv, "\n");
+        }
+    }
+
+    if (pthread_create(&m->tid, NULL, monitor_thread, m) != 0) {
+        fprintf(stderr, "Error: Cannot start monitor thread\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Stop the monitor, with a final report if periodic reporting is on
+void monitor_stop(Monitor *m)
+{
+    atomic_store(&m->stop, true);
+    pthread_kill(m->tid, SIGUSR1);
+    pthread_join(m->tid, NULL);
+    if (m->interval > 0 || m->csv) report(m, " final");
+    if (m->csv) fclose(m->csv);
+    free(m->last_thread_visits);
+    pthread_mutex_destroy(&m->lock);
+}
+
+void monitor_pause(Monitor *m)
+{
+    pthread_mutex_lock(&m->lock);
+}
+
+void monitor_resume(Monitor *m)
+{
+    pthread_mutex_unlock(&m->lock);
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#ifndef STATS_H
+#define STATS_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "types.h"
+
+// Per-thread training counters
+// - One cache line per thread so counting never shares a line with another thread
+typedef struct {
+    _Alignas(64) atomic_long deals;   // Deals finished
+    atomic_long visits;               // Nodes visited
+} ThreadCounters;
+
+// Live telemetry (--stats-every, --stats-csv, SIGUSR1)
+// - A monitor thread samples the counters and the table occupancy every interval
+//   seconds, and whenever SIGUSR1 arrives, and reports to stderr and the CSV; it
+//   sleeps until one of those is due
+// - Training threads only ever write their own counters; the monitor only reads
+typedef struct {
+    ThreadCounters *counters;
+    int threads;
+    int slices;
+    long total_buckets;
+    double interval;        // Seconds between reports (0 = SIGUSR1 only)
+    FILE *csv;
+    double start;
+    double last_time;
+    long last_deals;
+    long last_visits;
+    long *last_thread_visits;
+    atomic_bool stop;
+    pthread_mutex_t lock;   // Held by the monitor while it reports (see monitor_pause)
+    pthread_t tid;
+} Monitor;
+
+// Block SIGUSR1 in the calling thread and every thread it creates later; call it
+// first in main, so a SIGUSR1 during table loading waits for the monitor instead
+// of killing the process
+void stats_block_sigusr1(void);
+
+ThreadCounters *stats_alloc_counters(int threads);
+int monitor_start(Monitor *m, ThreadCounters *counters, int threads, int slices,
+                  double interval, const char *csv_file);
+void monitor_stop(Monitor *m);
+
+// Hold off reports, waiting for one in progress, e.g. so a fork never copies
+// the monitor's stdio or allocator state mid-update; monitor_resume ends it
+void monitor_pause(Monitor *m);
+void monitor_resume(Monitor *m);
+
+#endif // STATS_H
@@ -0,0 +1,237 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#include "table.h"
+#include "cfr.h"
+#include "strategy.h"
+#include "key.h"
+#include "game.h"
+#include <math.h>
+#include <limits.h>
+
+void sample_regret(Node **hash_table, int slices, RegretSample *out)
+{
+    double pos_regret[2] = {0}, visits[2] = {0};
+    memset(out, 0, sizeof(*out));
+
+    for (long i = 0; i < (long)NODE_QTY * slices; i++) {
+        for (Node *cur = hash_table[i]; cur; cur = cur->next) {
+            int stage = cur->key.bits[1] & 0x1;  // Key byte 1, bit 0 = stage
+            for (int j = 0; j < cur->action_count; j++) {
+                if (cur->regret_sum[j] > 0) pos_regret[stage] += cur->regret_sum[j];
+            }
+            visits[stage] += cur->visits;
+            out->nodes++;
+        }
+    }
+
+    for (int stage = BID; stage <= PLAY; stage++)
+        out->regret[stage] = (visits[stage] > 0) ? pos_regret[stage] / visits[stage] : 0.0;
+}
+
+// Chain lengths at or above this share the last histogram bin
+#define CHAIN_BINS 9
+// Longest chains listed
+#define WORST_BUCKETS 5
+
+typedef struct {
+    long nodes;
+    long used;
+    long hist[CHAIN_BINS];
+    long same_key;      // Node pairs in one chain with equal keys (different actions)
+    long max_chain;
+} ChainStats;
+
+typedef struct {
+    int slice;
+    long bucket;
+    long length;
+} WorstBucket;
+
+static void print_chain_stats(const char *label, const ChainStats *cs, long buckets)
+{
+    double load = (double)cs->nodes / buckets;
+    printf("%s: %ld nodes in %ld buckets, load %.3f, empty %.2f%% (uniform hash %.2f%%), "
+           "avg chain %.3f, max %ld, same-key pairs %ld\n", label, cs->nodes, buckets, load,
+           100.0 * (buckets - cs->used) / buckets, 100.0 * exp(-load),
+           cs->used ? (double)cs->nodes / cs->used : 0.0, cs->max_chain, cs->same_key);
+}
+
+void hash_report(Node **hash_table, int slices)
+{
+    ChainStats total = {0};
+    WorstBucket worst[WORST_BUCKETS] = {0};
+
+    printf("=== Hash Table Report ===\n");
+    for (int t = 0; t < slices; t++) {
+        ChainStats cs = {0};
+        Node **base = hash_table + (long)NODE_QTY * t;
+        for (long i = 0; i < NODE_QTY; i++) {
+            long len = 0;
+            for (Node *cur = base[i]; cur; cur = cur->next) {
+                len++;
+                for (Node *later = cur->next; later; later = later->next)
+                    cs.same_key += key_equal(&cur->key, &later->key);
+            }
+            cs.hist[(len < CHAIN_BINS - 1) ? len : CHAIN_BINS - 1]++;
+            if (len == 0) continue;
+            cs.used++;
+            cs.nodes += len;
+            if (len > cs.max_chain) cs.max_chain = len;
+
+            // Keep the longest chains, longest first
+            if (len > worst[WORST_BUCKETS - 1].length) {
+                int k = WORST_BUCKETS - 1;
+                while (k > 0 && len > worst[k - 1].length) {
+                    worst[k] = worst[k - 1];
+                    k--;
+                }
+                worst[k] = (WorstBucket){ t, i, len };
+            }
+        }
+
+        char label[32];
+        snprintf(label, sizeof(label), "Slice %d", t);
+        print_chain_stats(label, &cs, NODE_QTY);
+        total.nodes += cs.nodes;
+        total.used += cs.used;
+        total.same_key += cs.same_key;
+        if (cs.max_chain > total.max_chain) total.max_chain = cs.max_chain;
+        for (int b = 0; b < CHAIN_BINS; b++) total.hist[b] += cs.hist[b];
+    }
+
+    if (slices > 1) print_chain_stats("All slices", &total, (long)NODE_QTY * slices);
+    printf("Chain length histogram:\n");
+    for (int b = 0; b < CHAIN_BINS; b++)
+        printf("  %s%d: %ld\n", (b == CHAIN_BINS - 1) ? ">=" : "  ", b, total.hist[b]);
+    printf("Longest chains:\n");
+    for (int k = 0; k < WORST_BUCKETS && worst[k].length > 0; k++)
+        printf("  slice %d bucket %ld: %ld nodes\n", worst[k].slice, worst[k].bucket, worst[k].length);
+}
+
+// Visit histogram: one bin per count below EVICT_EXACT, then one per power of two,
+// so every node, however hot, falls in a bin the cutoff can pass
+#define EVICT_EXACT 64
+#define EVICT_EXACT_LOG 6
+#define EVICT_BINS (EVICT_EXACT + 31 - EVICT_EXACT_LOG)
+
+static int visit_bin(int visits)
+{
+    if (visits < EVICT_EXACT) return (visits > 0) ? visits : 0;
+    return EVICT_EXACT + (31 - __builtin_clz((unsigned)visits)) - EVICT_EXACT_LOG;
+}
+
+// Lowest visit count in bin b
+static int bin_floor(int b)
+{
+    return (b < EVICT_EXACT) ? b : 1 << (b - EVICT_EXACT + EVICT_EXACT_LOG);
+}
+
+long evict_cold_nodes(Node **hash_table, int slice, long target, int *cutoff)
+{
+    Node **base = hash_table + (long)NODE_QTY * slice;
+    long hist[EVICT_BINS] = {0};
+    long live = 0;
+
+    for (long i = 0; i < NODE_QTY; i++) {
+        for (Node *cur = base[i]; cur; cur = cur->next) {
+            hist[visit_bin(cur->visits)]++;
+            live++;
+        }
+    }
+
+    // Lowest cutoff bin that brings the slice down to target
+    int c = 0;
+    long freed = 0;
+    while (c < EVICT_BINS && live - freed > target)
+        freed += hist[c++];
+    *cutoff = (c < EVICT_BINS) ? bin_floor(c) : INT_MAX;
+    if (freed == 0) return 0;
+
+    long emptied = 0;
+    for (long i = 0; i < NODE_QTY; i++) {
+        if (!base[i]) continue;
+        Node **link = &base[i];
+        while (*link) {
+            Node *cur = *link;
+            if (visit_bin(cur->visits) < c) {
+                *link = cur->next;
+                free(cur);
+            } else {
+                link = &cur->next;
+            }
+        }
+        if (!base[i]) emptied++;
+    }
+    cfr_release_nodes(slice, freed, emptied);
+    return freed;
+}
+
+// Seed the node of the slice that owns the key (hash_key modulo slices) from
+// probabilities p[]
+// - Returns false, without changing anything, if the file already seeded this
+//   information set
+static bool seed_node(Node **hash_table, int slices, const UC *bits, UC action_count,
+                      const UC *action, const float *p, float weight, float regret)
+{
+    Key k = key_from_bits(bits);
+    // Files from older builds may not list actions in bit order
+    UC order[MAX_ACTIONS], act[MAX_ACTIONS];
+    float sums[MAX_ACTIONS], regrets[MAX_ACTIONS];
+    action_order(action, action_count, order);
+    for (int j = 0; j < action_count; j++) {
+        act[j] = action[order[j]];
+        sums[j] = p[order[j]] * weight;
+        regrets[j] = p[order[j]] * regret;
+    }
+    uint16_t mask = action_mask(act, action_count);
+    int t = (int)(hash_key(&k) % (unsigned int)slices);
+    if (lookup_node(hash_table, &k, mask, t)) return false;
+    Node *node = get_or_create(hash_table, &k, act, action_count, mask, t);
+    for (int j = 0; j < action_count; j++)
+        node->regret_sum[j] += regrets[j];
+    node_add_average_sums(node, sums);
+    return true;
+}
+
+long warm_start(const char *filename, char format, float weight, float regret,
+                Node **hash_table, int slices)
+{
+    long count = 0, duplicates = 0;
+    float p[MAX_ACTIONS];
+
+    if (format == 'Q' || format == 'q') {
+        Strat_255 *strat = load_strategy(filename, &count);
+        if (!strat) return -1;
+        for (long i = 0; i < count; i++) {
+            Strat_255 *st = &strat[i];
+            float sum = 0.0f;
+            for (int j = 0; j < st->action_count; j++) sum += st->s255[j];
+            for (int j = 0; j < st->action_count; j++)
+                p[j] = (sum > 0) ? st->s255[j] / sum : 1.0f / st->action_count;
+            if (!seed_node(hash_table, slices, st->bits, st->action_count, st->action, p, weight, regret))
+                duplicates++;
+        }
+        free_strategy(strat, count);
+    } else {
+        FILE *fp = fopen(filename, "rb");
+        if (!fp) {
+            fprintf(stderr, "Error: Cannot open warm-start file %s\n", filename);
+            return -1;
+        }
+        Strat st;
+        while (fread(&st, sizeof(Strat), 1, fp) == 1) {
+            if (!seed_node(hash_table, slices, st.bits, st.action_count, st.action, st.strategy,
+                           weight, regret))
+                duplicates++;
+            count++;
+        }
+        fclose(fp);
+    }
+
+    if (duplicates > 0)
+        fprintf(stderr, "Warning: %s lists %ld information sets more than once; only the first "
+                        "record of each was used (merge it with ct-kwayp first)\n", filename, duplicates);
+    printf("Warm start: %ld nodes from %s, each in its owner slice of %d\n", count - duplicates,
+           filename, slices);
+    return count - duplicates;
+}
@@ -0,0 +1,46 @@
+// Copyright (c) 2026 Dave Hugh. All rights reserved.
+// Licensed under the GPL v3.0 License. See README.md for details.
+#ifndef TABLE_H
+#define TABLE_H
+
+#include "types.h"
+
+// Whole-table passes over the node hash table (run between training segments)
+
+// Convergence sample: visit-weighted average positive regret by stage
+// - sum over nodes of sum_i max(regret_sum[i], 0), divided by total visits;
+//   this bounds the average regret per visit and falls toward 0 as CFR converges
+typedef struct {
+    long nodes;
+    double regret[2];   // Indexed by BID / PLAY
+} RegretSample;
+
+void sample_regret(Node **hash_table, int slices, RegretSample *out);
+
+// Warm start: seed the table from an existing strategy file
+// - Each information set goes into one slice, the one hash_key picks, so memory does
+//   not grow with the thread count; other slices that reach it start from uniform
+// - format 'S' reads Strat (ct output), 'Q' reads Strat_255 (merged ct-kwayp output)
+// - A record for an information set already seeded is skipped, with a warning
+//   (an unmerged ct output can list one per slice)
+// - Adds p * weight to the average strategy, so the prior counts as weight visits'
+//   worth of average, and p * regret to regret_sum (0 = start from uniform as usual)
+// - visits stay 0: prior nodes the new run never reaches are pruned by visit_threshold
+long warm_start(const char *filename, char format, float weight, float regret,
+                Node **hash_table, int slices);
+
+// Hash table quality report (--hash-report), per slice and overall
+// - Chain-length histogram, empty-bucket ratio against the ideal for a uniform hash
+//   at the same load, key-equal/action-different node pairs and the longest chains
+void hash_report(Node **hash_table, int slices);
+
+// Evict the coldest nodes of one slice until at most target nodes remain
+// - Frees every node with visits below a cutoff, raising the cutoff (from 1) until
+//   enough are gone; above 64 visits the cutoff moves in powers of two, so it can
+//   overshoot the target but always reaches it
+// - Evicted nodes restart from zero if training reaches them again
+// - The slice must not be in use by any other thread
+// - Returns the number of nodes freed and stores the cutoff used
+long evict_cold_nodes(Node **hash_table, int slice, long target, int *cutoff);
+
+#endif // TABLE_H
@@ -0,0 +1,35 @@
+#!/bin/bash
+
+# sorted_shards.sh - Check that --sorted --shards output does not depend on the thread count
+# Usage: tests/sorted_shards.sh [bin_dir] [threads] [deals]
+# Trains the same --shards run on 1 and on threads (default 3) threads and compares
+# the sorted outputs byte for byte; exits 1 if they differ
+
+bin="${1:-bin}"
+threads="${2:-3}"
+deals="${3:-200}"
+shards=4
+
+if [ ! -x "$bin/ct" ]; then
+    echo "Error: $bin/ct not found"
+    exit 1
+fi
+
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+echo "=== Sorted output determinism (--shards $shards, 1 vs $threads threads) ==="
+for t in 1 "$threads"; do
+    if ! "$bin/ct" --shards "$shards" --sorted "$t" "$deals" 0 "$dir/out$t.bin" 7 > "$dir/log$t.txt" 2>&1; then
+        echo "Error: ct failed on $t thread(s), see below"
+        cat "$dir/log$t.txt"
+        exit 1
+    fi
+done
+
+if cmp -s "$dir/out1.bin" "$dir/out$threads.bin"; then
+    echo "ok: outputs are byte-identical"
+else
+    echo "FAIL: outputs differ"
+    exit 1
+fi